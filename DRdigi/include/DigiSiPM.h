@@ -2,8 +2,9 @@
 #define DigiSiPM_h 1
 
 #include "edm4hep/RawCalorimeterHitCollection.h"
-#include "edm4hep/SparseVectorCollection.h"
+#include "edm4hep/SparseWaveformCollection.h"
 #include "edm4hep/EventHeaderCollection.h"
+#include "edm4hep/SiPMPhotonRecordCollection.h"
 
 #include "k4FWCore/DataHandle.h"
 
@@ -11,6 +12,11 @@
 #include "GaudiKernel/ToolHandle.h"
 
 #include "SiPMSensor.h"
+#include "DRcaloRandom.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 class DigiSiPM : public GaudiAlgorithm {
 public:
@@ -22,13 +28,23 @@ public:
   StatusCode finalize();
 
 private:
+  // the sensor is reseeded per hit with the key of the (seed, event, cell) stream
+  void digitize(std::uint64_t key, const std::vector<double>& times, const edm4hep::RawCalorimeterHit& rawhit,
+                edm4hep::RawCalorimeterHitCollection* digiHits, edm4hep::SparseWaveformCollection* waveforms);
+
+  // linear interpolation of the efficiency table, 1 if the table is empty
+  double efficiency(const std::vector<double>& wavlens, const std::vector<double>& effs, double wavlen) const;
+
+  DataHandle<edm4hep::EventHeaderCollection> m_eventHeader{"EventHeader", Gaudi::DataHandle::Reader, this};
   DataHandle<edm4hep::RawCalorimeterHitCollection> m_rawHits{"RawCalorimeterHits", Gaudi::DataHandle::Reader, this};
-  DataHandle<edm4hep::SparseVectorCollection> m_timeStruct{"RawTimeStructs", Gaudi::DataHandle::Reader, this};
+  DataHandle<edm4hep::SparseWaveformCollection> m_timeStruct{"RawTimeStructs", Gaudi::DataHandle::Reader, this};
+  DataHandle<edm4hep::SiPMPhotonRecordCollection> m_photonRecords{"RawPhotonRecords", Gaudi::DataHandle::Reader, this};
 
   DataHandle<edm4hep::RawCalorimeterHitCollection> m_digiHits{"DigiCalorimeterHits", Gaudi::DataHandle::Writer, this};
-  DataHandle<edm4hep::SparseVectorCollection> m_waveforms{"DigiWaveforms", Gaudi::DataHandle::Writer, this};
+  DataHandle<edm4hep::SparseWaveformCollection> m_waveforms{"DigiWaveforms", Gaudi::DataHandle::Writer, this};
 
   std::unique_ptr<sipm::SiPMSensor> m_sensor;
+  std::vector<std::pair<int, double>> m_bins; // (bin, amplitude) of a waveform above the threshold
 
   // Hamamatsu S14160-1310PS
   Gaudi::Property<double> m_sigLength{this, "signalLength", 200., "signal length in ns"};
@@ -47,6 +63,16 @@ private:
   Gaudi::Property<double> m_gateStart{this, "gateStart", 10., "Integration gate starting time in ns"};
   Gaudi::Property<double> m_gateL{this, "gateLength", 90., "Integration gate length in ns"};  // Should be approx 5 times fallTimeFast (see above)
   Gaudi::Property<double> m_thres{this, "threshold", 1.5, "Integration threshold"};  // Threshold in pe (1.5 to suppress DCR)
+  Gaudi::Property<double> m_precision{this, "waveformPrecision", 0.01, "Quantization step of the amplitude of DigiWaveforms in pe"};
+
+  Gaudi::Property<unsigned long> m_seed{this, "seed", 0, "Seed of the random streams, one per run & event number (EventHeader) & cell (the digis do not depend on the order of the hits, events nor jobs)"};
+
+  // replay of the exact photon records (requires a simulation with the filter & PDE switched off)
+  Gaudi::Property<bool> m_replay{this, "replayPhotons", false, "Digitize from RawPhotonRecords instead of RawTimeStructs"};
+  Gaudi::Property<std::vector<double>> m_filterWavlen{this, "filterWavlen", {}, "wavelength of the filter transmittance table in nm"};
+  Gaudi::Property<std::vector<double>> m_filterEff{this, "filterEff", {}, "filter transmittance (scintillation channel only)"};
+  Gaudi::Property<std::vector<double>> m_pdeWavlen{this, "pdeWavlen", {}, "wavelength of the PDE table in nm"};
+  Gaudi::Property<std::vector<double>> m_pdeEff{this, "pdeEff", {}, "SiPM photon detection efficiency"};
 };
 
 #endif
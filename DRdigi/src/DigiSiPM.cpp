@@ -1,5 +1,8 @@
 #include "DigiSiPM.h"
 
+#include "DRcaloWaveform.h"
+
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 
@@ -27,18 +30,81 @@ StatusCode DigiSiPM::initialize() {
 
   m_sensor = std::make_unique<sipm::SiPMSensor>(properties); // must be constructed from SiPMProperties
 
+  if (m_replay) {
+    if ( m_filterWavlen.size()!=m_filterEff.size() || m_pdeWavlen.size()!=m_pdeEff.size() ) {
+      error() << "Wavelength and efficiency tables of the filter & PDE must have the same size!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    if ( !std::is_sorted(m_filterWavlen.begin(),m_filterWavlen.end()) || !std::is_sorted(m_pdeWavlen.begin(),m_pdeWavlen.end()) ) {
+      error() << "Wavelength of the filter & PDE tables must be in increasing order!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    info() << "DigiSiPM will replay the photon records" << endmsg;
+  }
+
   info() << "DigiSiPM initialized" << endmsg;
 
   return StatusCode::SUCCESS;
 }
 
 StatusCode DigiSiPM::execute() {
-  const edm4hep::SparseVectorCollection* timeStructs = m_timeStruct.get();
   const edm4hep::RawCalorimeterHitCollection* rawHits = m_rawHits.get();
 
-  edm4hep::SparseVectorCollection* waveforms = m_waveforms.createAndPut();
+  edm4hep::SparseWaveformCollection* waveforms = m_waveforms.createAndPut();
   edm4hep::RawCalorimeterHitCollection* digiHits = m_digiHits.createAndPut();
 
+  // keyed by the run & event numbers rather than the index of the event in the job,
+  // so that an event gets the same streams whatever slice of the input the job processes
+  const edm4hep::EventHeaderCollection* headers = m_eventHeader.get();
+
+  if ( headers->size()==0 ) {
+    error() << "EventHeader is empty, unable to key the random streams of the event" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  const auto& header = headers->at(0);
+  std::uint64_t eventKey = drc::DRcaloRandom::key( m_seed, static_cast<std::uint64_t>( header.getRunNumber() ) );
+  eventKey = drc::DRcaloRandom::key( eventKey, static_cast<std::uint64_t>( header.getEventNumber() ) );
+
+  if (m_replay) {
+    const edm4hep::SiPMPhotonRecordCollection* photonRecords = m_photonRecords.get();
+
+    for (unsigned int idx = 0; idx < photonRecords->size(); idx++) {
+      const auto& record = photonRecords->at(idx);
+      const auto& rawhit = rawHits->at(record.getAssocObj().index);
+      const bool applyFilter = ( record.getType()==0 ); // filter is attached to the scintillation fibers only
+
+      const bool mixed = ( record.weights_size() > 0 );
+      drc::DRcaloRandom random( eventKey, rawhit.getCellID() );
+
+      std::vector<double> times;
+      times.reserve( record.times_size()*record.getWeight() );
+
+      int time = 0;
+      for (unsigned int iPhoton = 0; iPhoton < record.times_size(); iPhoton++) {
+        time += record.getTimes(iPhoton);
+        double wavlen = static_cast<double>( record.getWavlens(iPhoton) )*record.getWavlenPrecision();
+
+        double prob = efficiency(m_pdeWavlen,m_pdeEff,wavlen);
+        if (applyFilter) prob *= efficiency(m_filterWavlen,m_filterEff,wavlen);
+
+        // a weighted photon survives or dies as a whole
+        const int weight = mixed ? record.getWeights(iPhoton) : record.getWeight();
+
+        if ( random.flat() < prob )
+          times.insert( times.end(), weight, static_cast<double>(time)*record.getTimePrecision() );
+      }
+
+      digitize(drc::DRcaloRandom::key(eventKey,rawhit.getCellID()), times, rawhit, digiHits, waveforms);
+    }
+
+    return StatusCode::SUCCESS;
+  }
+
+  const edm4hep::SparseWaveformCollection* timeStructs = m_timeStruct.get();
+
   for (unsigned int idx = 0; idx < timeStructs->size(); idx++) {
     const auto& timeStruct = timeStructs->at(idx);
     const auto& rawhit = rawHits->at(timeStruct.getAssocObj().index);
@@ -46,49 +112,64 @@ StatusCode DigiSiPM::execute() {
     std::vector<double> times;
     times.reserve( rawhit.getAmplitude() );
 
-    for (unsigned int bin = 0; bin < timeStruct.contents_size(); bin++) {
-      int counts = static_cast<int>( timeStruct.getContents(bin) );
-      double timeBin = timeStruct.getCenters(bin);
+    drc::waveform::forEachBin( timeStruct, [&times](double timeBin, double content) {
+      times.insert( times.end(), static_cast<size_t>( std::lround(content) ), timeBin );
+    } );
 
-      for (int num = 0; num < counts; num++)
-        times.emplace_back(timeBin);
-    }
+    digitize(drc::DRcaloRandom::key(eventKey,rawhit.getCellID()), times, rawhit, digiHits, waveforms);
+  }
+
+  return StatusCode::SUCCESS;
+}
 
-    m_sensor->resetState();
-    m_sensor->addPhotons(times); // Sets photon times (times are in ns) (not appending)
-    m_sensor->runEvent();        // Runs the simulation
+void DigiSiPM::digitize(std::uint64_t key, const std::vector<double>& times, const edm4hep::RawCalorimeterHit& rawhit,
+                        edm4hep::RawCalorimeterHitCollection* digiHits, edm4hep::SparseWaveformCollection* waveforms) {
+  m_sensor->rng().seed(key);
+  m_sensor->resetState();
+  m_sensor->addPhotons(times); // Sets photon times (times are in ns) (not appending)
+  m_sensor->runEvent();        // Runs the simulation
 
-    auto digiHit = digiHits->create();
-    auto waveform = waveforms->create();
+  auto digiHit = digiHits->create();
+  auto waveform = waveforms->create();
 
-    // Using only analog signal (ADC conversion is still experimental)
-    const sipm::SiPMAnalogSignal anaSignal = m_sensor->signal();
+  // Using only analog signal (ADC conversion is still experimental)
+  const sipm::SiPMAnalogSignal anaSignal = m_sensor->signal();
 
-    const double integral = anaSignal.integral(m_gateStart,m_gateL,m_thres); // (intStart, intGate, threshold)
-    const double toa = anaSignal.toa(m_gateStart,m_gateL,m_thres);           // (intStart, intGate, threshold)
+  const double integral = anaSignal.integral(m_gateStart,m_gateL,m_thres); // (intStart, intGate, threshold)
+  const double toa = anaSignal.toa(m_gateStart,m_gateL,m_thres);           // (intStart, intGate, threshold)
 
-    digiHit.setAmplitude( integral );
-    digiHit.setCellID( rawhit.getCellID() );
-    // Toa and m_gateStart are in ns
-    digiHit.setTimeStamp( static_cast<int>((toa+m_gateStart)/m_sampling) );
-    waveform.setAssocObj( edm4hep::ObjectID( digiHit.getObjectID() ) );
-    waveform.setSampling( m_sampling );
+  digiHit.setAmplitude( integral );
+  digiHit.setCellID( rawhit.getCellID() );
+  // Toa and m_gateStart are in ns
+  digiHit.setTimeStamp( static_cast<int>((toa+m_gateStart)/m_sampling) );
+  waveform.setAssocObj( edm4hep::ObjectID( digiHit.getObjectID() ) );
 
-    // sipm::SiPMAnalogSignal can be iterated as an std::vector<double>
-    for (unsigned bin = 0; bin < anaSignal.size(); bin++) {
-      double amp = anaSignal[bin];
+  // sipm::SiPMAnalogSignal can be iterated as an std::vector<double>
+  m_bins.clear();
 
-      if (amp < m_thres) continue;
+  for (unsigned bin = 0; bin < anaSignal.size(); bin++) {
+    double amp = anaSignal[bin];
 
-      double tStart = static_cast<double>(bin)*m_sampling;
-      double tEnd = static_cast<double>(bin+1)*m_sampling;
+    if (amp < m_thres) continue;
 
-      waveform.addToContents( amp );
-      waveform.addToCenters( (tStart+tEnd)/2. );
-    }
+    m_bins.emplace_back( static_cast<int>(bin), amp );
   }
 
-  return StatusCode::SUCCESS;
+  drc::waveform::fill(waveform, 0., m_sampling, m_precision, m_bins);
+}
+
+double DigiSiPM::efficiency(const std::vector<double>& wavlens, const std::vector<double>& effs, double wavlen) const {
+  if (wavlens.empty()) return 1.;
+
+  auto upper = std::upper_bound(wavlens.begin(), wavlens.end(), wavlen);
+
+  if (upper==wavlens.begin()) return effs.front();
+  if (upper==wavlens.end()) return effs.back();
+
+  size_t idx = std::distance(wavlens.begin(), upper);
+  double frac = (wavlen - wavlens.at(idx-1))/(wavlens.at(idx) - wavlens.at(idx-1));
+
+  return effs.at(idx-1) + frac*(effs.at(idx) - effs.at(idx-1));
 }
 
 StatusCode DigiSiPM::finalize() {
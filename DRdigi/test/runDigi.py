@@ -5,7 +5,7 @@ from Configurables import k4DataSvc
 dataservice = k4DataSvc("EventDataSvc", input="sim.root")
 
 from Configurables import PodioInput
-podioinput = PodioInput("PodioInput", collections = ["RawTimeStructs", "RawCalorimeterHits", "SimCalorimeterHits", "Sim3dCalorimeterHits", "RawWavlenStructs", "GenParticles", "Leakages"], OutputLevel = DEBUG)
+podioinput = PodioInput("PodioInput", collections = ["EventHeader", "RawTimeStructs", "RawCalorimeterHits", "SimCalorimeterHits", "Sim3dCalorimeterHits", "RawWavlenStructs", "GenParticles", "Leakages"], OutputLevel = DEBUG)
 
 from Configurables import DigiSiPM
 digi = DigiSiPM("DigiSiPM", OutputLevel=DEBUG)
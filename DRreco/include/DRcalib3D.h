@@ -8,11 +8,14 @@
 
 #include "edm4hep/RawCalorimeterHitCollection.h"
 #include "edm4hep/CalorimeterHitCollection.h"
-#include "edm4hep/SparseVectorCollection.h"
+#include "edm4hep/SparseWaveformCollection.h"
 
 #include "GridDRcalo.h"
 #include "k4Interface/IGeoSvc.h"
 
+#include <utility>
+#include <vector>
+
 class TH1D;
 class IGeoSvc;
 
@@ -30,15 +33,15 @@ public:
 private:
   ServiceHandle<IGeoSvc> m_geoSvc;
   dd4hep::DDSegmentation::GridDRcalo* pSeg;
-  dd4hep::DDSegmentation::DRparamBase* pParamBase;
   std::unique_ptr<TH1D> m_veloC;
   std::unique_ptr<TH1D> m_veloS;
+  std::vector<std::pair<int, double>> m_bins; // (bin, content) of a postprocessed waveform
 
   DataHandle<edm4hep::RawCalorimeterHitCollection> m_digiHits{"DigiCalorimeterHits", Gaudi::DataHandle::Reader, this};
-  DataHandle<edm4hep::SparseVectorCollection> m_waveforms{"DigiWaveforms", Gaudi::DataHandle::Reader, this};
+  DataHandle<edm4hep::SparseWaveformCollection> m_waveforms{"DigiWaveforms", Gaudi::DataHandle::Reader, this};
   DataHandle<edm4hep::CalorimeterHitCollection> m_2dHits{"DRcalo2dHits", Gaudi::DataHandle::Reader, this};
   DataHandle<edm4hep::CalorimeterHitCollection> m_caloHits{"DRcalo3dHits", Gaudi::DataHandle::Writer, this};
-  DataHandle<edm4hep::SparseVectorCollection> m_postprocTime{"DRpostprocTime", Gaudi::DataHandle::Writer, this};
+  DataHandle<edm4hep::SparseWaveformCollection> m_postprocTime{"DRpostprocTime", Gaudi::DataHandle::Writer, this};
 
   Gaudi::Property<std::string> m_readoutName{this, "readoutName", "DRcaloSiPMreadout", "readout name of DRcalo"};
   Gaudi::Property<std::string> m_veloFile{this, "veloFile", "share/velo.root", "velocity profile file name"};
@@ -50,6 +53,7 @@ private:
   Gaudi::Property<double> m_gateL{this, "gateLength", 90., "Integration gate length in ns"};
   Gaudi::Property<double> m_zero{this, "threshold", 0.01, "FFT postprocessing threshold (ratio to the peak)"};
   Gaudi::Property<int> m_nbins{this, "nbins", 900, "number of bins for FFT"};
+  Gaudi::Property<double> m_precision{this, "waveformPrecision", 0.01, "Quantization step of the contents of DRpostprocTime"};
 
   Gaudi::Property<double> m_scintScale{this, "scintScale", 1.232, "Scintillation longitudinal scale"};
   Gaudi::Property<double> m_cherenScale{this, "cherenScale", 1.125, "Cherenkov longitudinal scale"};
@@ -13,7 +13,6 @@ DRcalib2D::DRcalib2D(const std::string& aName, ISvcLocator* aSvcLoc) : GaudiAlgo
   declareProperty("GeoSvc", m_geoSvc);
 
   pSeg = nullptr;
-  pParamBase = nullptr;
 }
 
 StatusCode DRcalib2D::initialize() {
@@ -49,9 +48,7 @@ StatusCode DRcalib2D::execute() {
 
     auto cID = static_cast<dd4hep::DDSegmentation::CellID>( digiHit.getCellID() );
     int numEta = pSeg->numEta(cID);
-
-    pParamBase = pSeg->setParamBase(numEta);
-    int absNumEta = pParamBase->unsignedTowerNo(numEta);
+    int absNumEta = pSeg->unsignedTowerNo(numEta);
 
     auto caloHit = caloHits->create();
     caloHit.setPosition( getPosition(cID) );
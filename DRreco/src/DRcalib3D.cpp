@@ -1,5 +1,7 @@
 #include "DRcalib3D.h"
 
+#include "DRcaloWaveform.h"
+
 #include "DD4hep/DD4hepUnits.h"
 #include "CLHEP/Units/SystemOfUnits.h"
 
@@ -17,7 +19,6 @@ DRcalib3D::DRcalib3D(const std::string& aName, ISvcLocator* aSvcLoc) : GaudiAlgo
   declareProperty("GeoSvc", m_geoSvc);
 
   pSeg = nullptr;
-  pParamBase = nullptr;
 }
 
 StatusCode DRcalib3D::initialize() {
@@ -47,9 +48,12 @@ StatusCode DRcalib3D::initialize() {
 StatusCode DRcalib3D::execute() {
   const edm4hep::RawCalorimeterHitCollection* digiHits = m_digiHits.get();
   const edm4hep::CalorimeterHitCollection* hits2d = m_2dHits.get();
-  const edm4hep::SparseVectorCollection* waveforms = m_waveforms.get();
+  const edm4hep::SparseWaveformCollection* waveforms = m_waveforms.get();
   edm4hep::CalorimeterHitCollection* caloHits = m_caloHits.createAndPut();
-  edm4hep::SparseVectorCollection* postprocTimes = m_postprocTime.createAndPut();
+  edm4hep::SparseWaveformCollection* postprocTimes = m_postprocTime.createAndPut();
+
+  // the bins of the FFT span the integration gate
+  const double procSampling = m_gateL/static_cast<double>(m_nbins.value());
 
   for (unsigned int idx = 0; idx < hits2d->size(); idx++) {
     // WARNING assume same input order (sequential access)
@@ -65,23 +69,24 @@ StatusCode DRcalib3D::execute() {
     }
 
     auto postprocTime = postprocTimes->create(); // create an object even if integral is 0 to match the order with other collections
-    postprocTime.setSampling( waveform.getSampling() );
     postprocTime.setAssocObj( waveform.getAssocObj() );
     double amplitude = static_cast<double>(digiHit.getAmplitude());
+    m_bins.clear();
 
-    if (amplitude <= 0.)
+    if (amplitude <= 0.) {
+      drc::waveform::fill(postprocTime, m_gateStart, procSampling, m_precision, m_bins);
       continue;
+    }
 
     // set segmentation parameter
     auto cID = static_cast<dd4hep::DDSegmentation::CellID>( hit2d.getCellID() );
     int numEta = pSeg->numEta(cID);
     int numPhi = pSeg->numPhi(cID);
-    pParamBase = pSeg->setParamBase(numEta);
 
     // estimate fiber geometry
     auto position = hit2d.getPosition();
-    auto towerPos = pParamBase->GetTowerPos(numPhi);
-    auto waferPos = pParamBase->GetSipmLayerPos(numPhi);
+    auto towerPos = pSeg->towerPos(numEta,numPhi);
+    auto waferPos = pSeg->sipmLayerPos(numEta,numPhi);
     dd4hep::Position sipmPos(position.x * dd4hep::millimeter/CLHEP::millimeter,
                              position.y * dd4hep::millimeter/CLHEP::millimeter,
                              position.z * dd4hep::millimeter/CLHEP::millimeter); // type cast to dd4hep::Position
@@ -89,16 +94,13 @@ StatusCode DRcalib3D::execute() {
     auto fiberDir = waferPos - towerPos; // outward direction
     auto fiberUnit = fiberDir.Unit();
 
-    double towerH = pParamBase->GetTowerH();
+    double towerH = pSeg->towerH(numEta);
     double scale = pSeg->IsCerenkov(cID) ? m_cherenScale.value() : m_scintScale.value();
 
     // create a histogram to do FFT and fill it
     std::unique_ptr<TH1D> waveHist = std::make_unique<TH1D>("waveHist","waveHist",m_nbins,m_gateStart,m_gateStart+m_gateL);
 
-    for (unsigned int bin = 0; bin < waveform.centers_size(); bin++) {
-      float timeBin = waveform.getCenters(bin);
-      waveHist->Fill(timeBin,waveform.getContents(bin));
-    }
+    drc::waveform::forEachBin( waveform, [&waveHist](double timeBin, double content) { waveHist->Fill(timeBin,content); } );
 
     // Fast Fourier Transform (Z-transform)
     std::unique_ptr<TH1> waveProcessed( processFFT(waveHist.get()) );
@@ -114,8 +116,7 @@ StatusCode DRcalib3D::execute() {
 
         if (con < thres) continue;
 
-        postprocTime.addToContents( con );
-        postprocTime.addToCenters( cen );
+        m_bins.emplace_back( bin-1, con );
 
         // scale effective velocity
         double veloScaled = pSeg->IsCerenkov(cID) ? m_veloC->Interpolate(cen-toaProc) : m_veloS->Interpolate(cen-toaProc);
@@ -139,6 +140,8 @@ StatusCode DRcalib3D::execute() {
         caloHit.setEnergy( energy );
       }
     }
+
+    drc::waveform::fill(postprocTime, m_gateStart, procSampling, m_precision, m_bins);
   }
 
   return StatusCode::SUCCESS;
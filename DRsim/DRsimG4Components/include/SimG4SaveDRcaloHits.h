@@ -2,17 +2,25 @@
 #define SimG4SaveDRcaloHits_h 1
 
 #include "DRcaloSiPMHit.h"
+#include "GridDRcalo.h"
 
 // Data model
 #include "edm4hep/RawCalorimeterHitCollection.h"
-#include "edm4hep/SparseVectorCollection.h"
+#include "edm4hep/SparseWaveformCollection.h"
+#include "edm4hep/SiPMPhotonRecordCollection.h"
 
 #include "GaudiAlg/GaudiTool.h"
 #include "k4FWCore/DataHandle.h"
 #include "k4Interface/ISimG4SaveOutputTool.h"
 #include "k4Interface/IGeoSvc.h"
 
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 class IGeoSvc;
+class G4HCofThisEvent;
 
 class SimG4SaveDRcaloHits : public GaudiTool, virtual public ISimG4SaveOutputTool {
 public:
@@ -25,14 +33,39 @@ public:
   virtual StatusCode saveOutput(const G4Event& aEvent) final;
 
 private:
+  /// hits collection IDs of the readouts to save, looked up once in the collections of the first event
+  void resolveCollections(G4HCofThisEvent* collections);
+
+  void savePhotonRecord(const drc::DRcaloSiPMHit* hit, const dd4hep::DDSegmentation::GridDRcalo* seg,
+                        const edm4hep::RawCalorimeterHit& caloHit, edm4hep::SiPMPhotonRecordCollection* photonRecords);
+
   /// Pointer to the geometry service
   ServiceHandle<IGeoSvc> m_geoSvc;
 
   Gaudi::Property<std::vector<std::string>> m_readoutNames{this, "readoutNames", {"DRcaloSiPMreadout"}, "Name of the readouts (hits collections) to save"};
 
+  Gaudi::Property<bool> m_savePhotons{this, "savePhotons", false, "Save exact arrival time & wavelength of each photon"};
+  Gaudi::Property<bool> m_hitArena{this, "hitArena", true, "Allocate the payloads of the SiPM hits from a per-event arena released in bulk (false for one by one on the heap)"};
+  Gaudi::Property<double> m_timePrecision{this, "timePrecision", 0.001, "Quantization step of the photon arrival time in ns"};
+  Gaudi::Property<double> m_wavlenPrecision{this, "wavlenPrecision", 0.1, "Quantization step of the photon wavelength in nm"};
+
+  /// segmentation of each readout to tell the channel of the photon records
+  std::map<std::string, dd4hep::DDSegmentation::GridDRcalo*> m_segs;
+
+  /// (hits collection ID, segmentation) of the readouts to save
+  std::vector<std::pair<int, const dd4hep::DDSegmentation::GridDRcalo*>> m_collections;
+  bool m_resolved = false;
+
+  /// (bin, count) of a time structure or wavelength spectrum, reused over the hits
+  std::vector<std::pair<int, int>> m_bins;
+
+  /// photons of a hit sorted in time, reused over the hits
+  std::vector<std::tuple<float, float, int>> m_photons;
+
   DataHandle<edm4hep::RawCalorimeterHitCollection> mRawCaloHits{"RawCalorimeterHits", Gaudi::DataHandle::Writer, this};
-  DataHandle<edm4hep::SparseVectorCollection> mTimeStruct{"RawTimeStructs", Gaudi::DataHandle::Writer, this};
-  DataHandle<edm4hep::SparseVectorCollection> mWavlenStruct{"RawWavlenStructs", Gaudi::DataHandle::Writer, this};
+  DataHandle<edm4hep::SparseWaveformCollection> mTimeStruct{"RawTimeStructs", Gaudi::DataHandle::Writer, this};
+  DataHandle<edm4hep::SparseWaveformCollection> mWavlenStruct{"RawWavlenStructs", Gaudi::DataHandle::Writer, this};
+  DataHandle<edm4hep::SiPMPhotonRecordCollection> mPhotonRecords{"RawPhotonRecords", Gaudi::DataHandle::Writer, this};
 };
 
 #endif
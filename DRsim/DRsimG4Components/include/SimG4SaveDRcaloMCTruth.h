@@ -10,7 +10,7 @@
 #include "k4Interface/ISimG4Svc.h"
 #include "k4Interface/ISimG4SaveOutputTool.h"
 
-#include "SimG4DRcaloEventAction.h"
+#include "SimG4DRcaloEventInformation.h"
 
 class IGeoSvc;
 
@@ -27,10 +27,9 @@ public:
 private:
   DataHandle<edm4hep::SimCalorimeterHitCollection> m_Edeps{"SimCalorimeterHits", Gaudi::DataHandle::Writer, this};
   DataHandle<edm4hep::SimCalorimeterHitCollection> m_Edeps3d{"Sim3dCalorimeterHits", Gaudi::DataHandle::Writer, this};
+  DataHandle<edm4hep::SimCalorimeterHitCollection> m_FiberEdeps{"SimFiberCalorimeterHits", Gaudi::DataHandle::Writer, this};
   DataHandle<edm4hep::MCParticleCollection> m_Leakages{"Leakages", Gaudi::DataHandle::Writer, this};
 
-  drc::SimG4DRcaloEventAction* m_eventAction;
-
   ServiceHandle<ISimG4Svc> m_geantSvc;
 };
 
@@ -1,11 +1,18 @@
 #include "SimG4SaveDRcaloHits.h"
 
+#include "DRcaloSiPMSD.h"
+#include "DRcaloWaveform.h"
+
 // Geant4
 #include "G4Event.hh"
+#include "G4HCofThisEvent.hh"
 
 // DD4hep
 #include "DD4hep/Detector.h"
 
+#include <algorithm>
+#include <cmath>
+
 DECLARE_COMPONENT(SimG4SaveDRcaloHits)
 
 SimG4SaveDRcaloHits::SimG4SaveDRcaloHits(const std::string& aType, const std::string& aName, const IInterface* aParent)
@@ -34,6 +41,31 @@ StatusCode SimG4SaveDRcaloHits::initialize() {
     } else {
       debug() << "Hits will be saved to EDM from the collection " << readoutName << endmsg;
     }
+
+    m_segs[readoutName] = dynamic_cast<dd4hep::DDSegmentation::GridDRcalo*>( lcdd->readout(readoutName).segmentation().segmentation() );
+  }
+
+  if ( m_savePhotons && ( m_timePrecision <= 0. || m_wavlenPrecision <= 0. ) ) {
+    error() << "Precision of the photon records should be positive!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  // configure the SDs we save, the SDs of the worker threads pick it up at their next event
+  for (auto& sdEntry : lcdd->sensitiveDetectors()) {
+    dd4hep::SensitiveDetector sd = sdEntry.second;
+
+    if (std::find(m_readoutNames.begin(), m_readoutNames.end(), sd.readout().name()) == m_readoutNames.end())
+      continue;
+
+    if (m_savePhotons) {
+      drc::DRcaloSiPMSD::recordPhotonsOf(sd.name());
+      debug() << "Photon records will be saved from the SD " << sd.name() << endmsg;
+    }
+
+    if (!m_hitArena) {
+      drc::DRcaloSiPMSD::heapPayloadsOf(sd.name());
+      debug() << "Hit payloads of the SD " << sd.name() << " will be allocated on the heap" << endmsg;
+    }
   }
 
   return StatusCode::SUCCESS;
@@ -43,59 +75,128 @@ StatusCode SimG4SaveDRcaloHits::finalize() { return GaudiTool::finalize(); }
 
 StatusCode SimG4SaveDRcaloHits::saveOutput(const G4Event& aEvent) {
   G4HCofThisEvent* collections = aEvent.GetHCofThisEvent();
-  G4VHitsCollection* collect;
-  drc::DRcaloSiPMHit* hit;
+
+  // the actions may be initialized after this tool, check at the first event
+  if ( m_savePhotons && !m_resolved && drc::DRcaloSiPMSD::filteredAtBirth() ) {
+    error() << "Photon records would be biased by the filter & PDE applied at birth, "
+            << "set applyFilter = False and applyPDE = False in SimG4DRcaloActions to save them" << endmsg;
+    return StatusCode::FAILURE;
+  }
 
   if (collections != nullptr) {
     edm4hep::RawCalorimeterHitCollection* caloHits = mRawCaloHits.createAndPut();
-    edm4hep::SparseVectorCollection* timeStructs = mTimeStruct.createAndPut();
-    edm4hep::SparseVectorCollection* wavStructs = mWavlenStruct.createAndPut();
+    edm4hep::SparseWaveformCollection* timeStructs = mTimeStruct.createAndPut();
+    edm4hep::SparseWaveformCollection* wavStructs = mWavlenStruct.createAndPut();
+    edm4hep::SiPMPhotonRecordCollection* photonRecords = m_savePhotons ? mPhotonRecords.createAndPut() : nullptr;
 
-    for (int iter_coll = 0; iter_coll < collections->GetNumberOfCollections(); iter_coll++) {
-      collect = collections->GetHC(iter_coll);
+    // the collection IDs are the same for every event & thread, resolve the readout names once
+    if (!m_resolved)
+      resolveCollections(collections);
 
-      if (std::find(m_readoutNames.begin(), m_readoutNames.end(), collect->GetName()) != m_readoutNames.end()) {
-        size_t n_hit = collect->GetSize();
+    for (const auto& readout : m_collections) {
+      auto* hits = dynamic_cast<drc::DRcaloSiPMHitsCollection*>( collections->GetHC(readout.first) );
 
-        for (size_t iter_hit = 0; iter_hit < n_hit; iter_hit++) {
-          hit = dynamic_cast<drc::DRcaloSiPMHit*>(collect->GetHit(iter_hit));
+      if (!hits)
+        continue;
 
-          auto caloHit = caloHits->create();
-          auto timeStruct = timeStructs->create();
-          auto wavStruct = wavStructs->create();
+      const size_t nHits = hits->GetSize();
 
-          float peakTime = 0.;
-          int peakVal = 0;
-          float samplingT = hit->GetSamplingTime();
-          for (auto& i_timeStruct : hit->GetTimeStruct()) {
-            timeStruct.addToContents(i_timeStruct.second);
-            timeStruct.addToCenters( i_timeStruct.first );
+      for (size_t iHit = 0; iHit < nHits; iHit++) {
+        const drc::DRcaloSiPMHit* hit = (*hits)[iHit];
 
-            int candidate = std::max( peakVal, i_timeStruct.second );
+        auto caloHit = caloHits->create();
+        auto timeStruct = timeStructs->create();
+        auto wavStruct = wavStructs->create();
 
-            if ( peakVal < candidate ) {
-              peakVal = candidate;
-              peakTime = i_timeStruct.first;
-            }
-          }
+        // bins & peak in a single pass over the time structure, the bins are counted from 0 ns
+        float peakTime = 0.;
+        int peakVal = 0;
+        const float samplingT = hit->GetSamplingTime();
+        m_bins.clear();
 
-          caloHit.setCellID( static_cast<unsigned long long>(hit->GetSiPMnum()) );
-          caloHit.setAmplitude( hit->GetPhotonCount() );
-          caloHit.setTimeStamp( static_cast<int>( peakTime / samplingT ) );
-          timeStruct.setSampling( samplingT );
-          timeStruct.setAssocObj( edm4hep::ObjectID( caloHit.getObjectID() ) );
+        for (const auto& bin : hit->GetTimeStruct()) {
+          m_bins.emplace_back( drc::waveform::bin(bin.first,0.,samplingT), bin.second );
 
-          float samplingW = hit->GetSamplingWavlen();
-          for (auto& i_wavlen : hit->GetWavlenSpectrum()) {
-            wavStruct.addToContents(i_wavlen.second);
-            wavStruct.addToCenters( i_wavlen.first );
+          if ( peakVal < bin.second ) {
+            peakVal = bin.second;
+            peakTime = bin.first;
           }
-          wavStruct.setSampling( samplingW );
-          wavStruct.setAssocObj( edm4hep::ObjectID( caloHit.getObjectID() ) );
         }
+
+        caloHit.setCellID( static_cast<unsigned long long>(hit->GetSiPMnum()) );
+        caloHit.setAmplitude( hit->GetPhotonCount() );
+        caloHit.setTimeStamp( static_cast<int>( peakTime / samplingT ) );
+        drc::waveform::fill(timeStruct, 0., samplingT, 1., m_bins);
+        timeStruct.setAssocObj( edm4hep::ObjectID( caloHit.getObjectID() ) );
+
+        const float samplingW = hit->GetSamplingWavlen();
+        m_bins.clear();
+
+        for (const auto& bin : hit->GetWavlenSpectrum())
+          m_bins.emplace_back( drc::waveform::bin(bin.first,0.,samplingW), bin.second );
+
+        drc::waveform::fill(wavStruct, 0., samplingW, 1., m_bins);
+        wavStruct.setAssocObj( edm4hep::ObjectID( caloHit.getObjectID() ) );
+
+        if (photonRecords)
+          savePhotonRecord(hit, readout.second, caloHit, photonRecords);
       }
     }
   }
 
   return StatusCode::SUCCESS;
 }
+
+void SimG4SaveDRcaloHits::resolveCollections(G4HCofThisEvent* collections) {
+  for (const auto& readoutName : m_readoutNames) {
+    int collectionID = -1;
+
+    for (int iColl = 0; iColl < collections->GetNumberOfCollections(); iColl++) {
+      if ( collections->GetHC(iColl) && collections->GetHC(iColl)->GetName()==readoutName ) {
+        collectionID = iColl;
+        break;
+      }
+    }
+
+    if ( collectionID < 0 ) {
+      warning() << "Hits collection " << readoutName << " is not in the event, it will not be saved" << endmsg;
+      continue;
+    }
+
+    m_collections.emplace_back( collectionID, m_segs.at(readoutName) );
+  }
+
+  m_resolved = true;
+}
+
+void SimG4SaveDRcaloHits::savePhotonRecord(const drc::DRcaloSiPMHit* hit, const dd4hep::DDSegmentation::GridDRcalo* seg,
+                                           const edm4hep::RawCalorimeterHit& caloHit, edm4hep::SiPMPhotonRecordCollection* photonRecords) {
+  // SD appends photons in the order of tracking, sort them in time before delta-coding
+  // the scratch buffer keeps its capacity over the hits & events
+  const auto& source = hit->GetPhotonRecord();
+  auto& photons = m_photons;
+  photons.assign(source.begin(), source.end());
+  std::sort(photons.begin(), photons.end());
+
+  auto record = photonRecords->create();
+  record.setTimePrecision( m_timePrecision );
+  record.setWavlenPrecision( m_wavlenPrecision );
+  record.setType( seg->IsCerenkov( hit->GetSiPMnum() ) ? 1 : 0 );
+  record.setAssocObj( edm4hep::ObjectID( caloHit.getObjectID() ) );
+
+  // a single weight covers the usual case, the weights per photon are stored only if they differ
+  const int weight = photons.empty() ? 1 : std::get<2>( photons.front() );
+  const bool mixed = std::any_of( photons.begin(), photons.end(), [weight](const auto& photon) { return std::get<2>(photon)!=weight; } );
+  record.setWeight(weight);
+
+  int prevTime = 0;
+  for (auto& photon : photons) {
+    int time = static_cast<int>( std::lround( std::get<0>(photon) / m_timePrecision ) );
+    record.addToTimes( time - prevTime );
+    record.addToWavlens( static_cast<int>( std::lround( std::get<1>(photon) / m_wavlenPrecision ) ) );
+    prevTime = time;
+
+    if (mixed)
+      record.addToWeights( std::get<2>(photon) );
+  }
+}
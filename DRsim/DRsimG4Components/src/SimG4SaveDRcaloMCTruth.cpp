@@ -1,6 +1,6 @@
 #include "SimG4SaveDRcaloMCTruth.h"
 
-#include "G4RunManager.hh"
+#include "G4Event.hh"
 
 DECLARE_COMPONENT(SimG4SaveDRcaloMCTruth)
 
@@ -20,29 +20,25 @@ StatusCode SimG4SaveDRcaloMCTruth::initialize() {
     return StatusCode::FAILURE;
   }
 
-  auto* runManager = G4RunManager::GetRunManager();
-  const auto* eventAction = dynamic_cast<const drc::SimG4DRcaloEventAction*>(runManager->GetUserEventAction());
-
-  if (!eventAction) {
-    error() << "Unable to cast to SimG4DRcaloEventAction from G4UserEventAction" << endmsg;
-    return StatusCode::FAILURE;
-  }
-
-  m_eventAction = const_cast<drc::SimG4DRcaloEventAction*>(eventAction); // HACK!!!
-
   return StatusCode::SUCCESS;
 }
 
 StatusCode SimG4SaveDRcaloMCTruth::finalize() { return GaudiTool::finalize(); }
 
-StatusCode SimG4SaveDRcaloMCTruth::saveOutput(const G4Event&) {
-  auto* edeps = m_eventAction->getEdepsCollection();
-  auto* edeps3d = m_eventAction->getEdeps3dCollection();
-  auto* leakages = m_eventAction->getLeakagesCollection();
+StatusCode SimG4SaveDRcaloMCTruth::saveOutput(const G4Event& aEvent) {
+  // the collections travel with the event, whichever thread processed it
+  auto* info = dynamic_cast<drc::SimG4DRcaloEventInformation*>( aEvent.GetUserInformation() );
+
+  if (!info) {
+    error() << "Unable to find SimG4DRcaloEventInformation of the event " << aEvent.GetEventID()
+            << ", make sure that SimG4DRcaloActions is used" << endmsg;
+    return StatusCode::FAILURE;
+  }
 
-  m_Edeps.put(edeps);
-  m_Edeps3d.put(edeps3d);
-  m_Leakages.put(leakages);
+  m_Edeps.put( info->releaseEdeps() );
+  m_Edeps3d.put( info->releaseEdeps3d() );
+  m_Leakages.put( info->releaseLeakages() );
+  m_FiberEdeps.put( info->releaseFiberEdeps() ); // empty unless fiberEdeps of SimG4DRcaloActions is on
 
   return StatusCode::SUCCESS;
 }
@@ -0,0 +1,93 @@
+# simulation throughput benchmark suite: runs runBenchmark.py for every fixed-seed single-particle configuration
+# (e- & pi- at 20 & 100 GeV, barrel & endcap, fast fiber model on & off) and gathers the JSON written by
+# SimG4DRcaloRunAction (benchmarkOutput) into a single JSON file together with the host & version
+# usage: python benchmarkDRsim.py [number of events] [output JSON] [substring of the configurations to run]
+# DRCALO_BENCH_ARENA=0 in the environment allocates the SiPM hit payloads on the heap, to compare the allocators
+import datetime
+import json
+import os
+import platform
+import subprocess
+import sys
+
+evtMax = int(sys.argv[1]) if len(sys.argv) > 1 else 10
+output = sys.argv[2] if len(sys.argv) > 2 else "benchmark.json"
+selection = sys.argv[3] if len(sys.argv) > 3 else ""
+seed = 123
+
+particles = [("e-", 11), ("pi-", -211)]
+energies = [20, 100] # GeV
+regions = ["barrel", "endcap"]
+fastFibers = [True, False]
+
+testDir = os.path.dirname(os.path.abspath(__file__))
+
+def gitVersion():
+  try:
+    return subprocess.check_output(["git", "describe", "--always", "--dirty"], cwd = testDir, stderr = subprocess.DEVNULL,
+                                   universal_newlines = True).strip()
+  except (OSError, subprocess.CalledProcessError):
+    return os.environ.get("DRCALO_VERSION", "unknown")
+
+def cpuModel():
+  try:
+    with open("/proc/cpuinfo") as cpuinfo:
+      for line in cpuinfo:
+        if line.startswith("model name"):
+          return line.split(":", 1)[1].strip()
+  except OSError:
+    pass
+
+  return platform.processor()
+
+suite = {
+  "version": gitVersion(),
+  "date": datetime.datetime.now().isoformat(timespec = "seconds"),
+  "host": { "name": platform.node(), "platform": platform.platform(), "cpu": cpuModel(), "cores": os.cpu_count() },
+  "events": evtMax,
+  "seed": seed,
+  "hitArena": os.environ.get("DRCALO_BENCH_ARENA", "1") == "1",
+  "runs": []
+}
+
+for particle, pdg in particles:
+  for energy in energies:
+    for region in regions:
+      for fastFiber in fastFibers:
+        name = "%s_%dGeV_%s_%s" % (particle, energy, region, "fastfiber" if fastFiber else "fullfiber")
+
+        if selection not in name:
+          continue
+
+        env = dict(os.environ,
+                   DRCALO_BENCH_PDG = str(pdg),
+                   DRCALO_BENCH_ENERGY = str(energy),
+                   DRCALO_BENCH_REGION = region,
+                   DRCALO_BENCH_FASTFIBER = "1" if fastFiber else "0",
+                   DRCALO_BENCH_EVTMAX = str(evtMax),
+                   DRCALO_BENCH_SEED = str(seed),
+                   DRCALO_BENCH_OUTPUT = "bench_" + name + ".json")
+
+        print("running " + name)
+        sys.stdout.flush()
+
+        with open("bench_" + name + ".log", "w") as log:
+          status = subprocess.call(["k4run", os.path.join(testDir, "runBenchmark.py")], env = env, stdout = log, stderr = subprocess.STDOUT)
+
+        run = { "name": name, "particle": particle, "pdg": pdg, "energy": energy, "region": region, "fastFiber": fastFiber, "status": status }
+
+        try:
+          with open("bench_" + name + ".json") as result:
+            run.update(json.load(result))
+        except (OSError, ValueError):
+          print("  no result, see bench_" + name + ".log")
+
+        if "eventsPerSecond" in run:
+          print("  %.4g events/s, %.4g s CPU/event, peak RSS %.0f MB" % (run["eventsPerSecond"], run["cpuTimePerEvent"], run["peakRSSMB"]))
+
+        suite["runs"].append(run)
+
+with open(output, "w") as out:
+  json.dump(suite, out, indent = 2)
+
+print("benchmark suite is written to " + output)
@@ -0,0 +1,112 @@
+# a configuration of the benchmark suite of benchmarkDRsim.py, set by the environment:
+# particle (PDG code), energy (GeV), barrel or endcap, fast fiber model on (1) or off (0), events, random seed & JSON output,
+# hit payloads from the per-event arena (1) or the heap (0)
+import os
+pdg = int(os.environ.get("DRCALO_BENCH_PDG", "11"))
+energy = float(os.environ.get("DRCALO_BENCH_ENERGY", "20"))
+isBarrel = os.environ.get("DRCALO_BENCH_REGION", "barrel") == "barrel"
+fastFiber = os.environ.get("DRCALO_BENCH_FASTFIBER", "1") == "1"
+evtMax = int(os.environ.get("DRCALO_BENCH_EVTMAX", "10"))
+seed = int(os.environ.get("DRCALO_BENCH_SEED", "123"))
+output = os.environ.get("DRCALO_BENCH_OUTPUT", "benchmark.json")
+hitArena = os.environ.get("DRCALO_BENCH_ARENA", "1") == "1"
+
+from Gaudi.Configuration import *
+from Configurables import ApplicationMgr
+from GaudiKernel import SystemOfUnits as units
+
+from Configurables import k4DataSvc
+dataservice = k4DataSvc("EventDataSvc")
+
+from Configurables import GenAlg, MomentumRangeParticleGun
+# the barrel configuration is the one of runDRsim.py, the endcap one hits the middle of the endcap
+theta = 1.5335 if isBarrel else 0.3708 # rad
+
+pgun = MomentumRangeParticleGun("PGun",
+  PdgCodes=[pdg],
+  MomentumMin = energy*units.GeV,
+  MomentumMax = energy*units.GeV,
+  ThetaMin = theta, # rad
+  ThetaMax = theta, # rad
+  PhiMin = 0.01745, # rad
+  PhiMax = 0.01745 # rad
+)
+
+from Configurables import FlatSmearVertex
+smearTool = FlatSmearVertex("VertexSmearingTool",
+  yVertexMin = -36.42 if isBarrel else 0., # mm
+  yVertexMax = -26.42 if isBarrel else 0., # mm
+  zVertexMin = -52.135 if isBarrel else 0., # mm
+  zVertexMax = -42.135 if isBarrel else 0., # mm
+  beamDirection = 0 # 1, 0, -1
+)
+
+from Configurables import HepMCToEDMConverter
+hepmc2edm = HepMCToEDMConverter("Converter")
+
+gen = GenAlg("ParticleGun", SignalProvider=pgun, VertexSmearingTool=smearTool)
+
+from Configurables import GeoSvc
+geoservice = GeoSvc(
+  "GeoSvc",
+  detectors = [
+    'file:share/compact/DRcalo.xml'
+  ]
+)
+
+from Configurables import SimG4Svc, SimG4FastSimPhysicsList, SimG4FastSimOpFiberRegion, SimG4OpticalPhysicsList
+regionTool = SimG4FastSimOpFiberRegion("fastfiber")
+opticalPhysicsTool = SimG4OpticalPhysicsList("opticalPhysics", fullphysics="SimG4FtfpBert")
+physicslistTool = SimG4FastSimPhysicsList("Physics", fullphysics=opticalPhysicsTool)
+
+from Configurables import SimG4DRcaloActions
+actionTool = SimG4DRcaloActions("SimG4DRcaloActions",
+  benchmarkOutput = output
+)
+
+# Name of the tool in GAUDI is "XX/YY" where XX is the tool class name and YY is the given name
+geantservice = SimG4Svc("SimG4Svc",
+  physicslist = physicslistTool,
+  regions = ["SimG4FastSimOpFiberRegion/fastfiber"] if fastFiber else [],
+  actions = actionTool
+)
+
+from Configurables import SimG4Alg, SimG4PrimariesFromEdmTool
+# next, create the G4 algorithm, giving the list of names of tools ("XX/YY")
+edmConverter = SimG4PrimariesFromEdmTool("EdmConverter")
+
+from Configurables import SimG4SaveDRcaloHits, SimG4SaveDRcaloMCTruth
+saveDRcaloTool = SimG4SaveDRcaloHits("saveDRcaloTool", readoutNames = ["DRcaloSiPMreadout"], hitArena = hitArena)
+saveMCTruthTool = SimG4SaveDRcaloMCTruth("saveMCTruthTool") # need SimG4DRcaloActions
+
+geantsim = SimG4Alg("SimG4Alg",
+  outputs = [
+    "SimG4SaveDRcaloHits/saveDRcaloTool",
+    "SimG4SaveDRcaloMCTruth/saveMCTruthTool"
+  ],
+  eventProvider = edmConverter
+)
+
+from Configurables import PodioOutput
+podiooutput = PodioOutput("PodioOutput", filename = os.path.splitext(output)[0] + ".root")
+podiooutput.outputCommands = ["keep *"]
+
+from Configurables import RndmGenSvc, HepRndm__Engine_CLHEP__RanluxEngine_
+rndmEngine = HepRndm__Engine_CLHEP__RanluxEngine_("RndmGenSvc.Engine",
+  SetSingleton = True,
+  UseTable = True,
+  Column = 0, # 0 or 1
+  Row = seed # 0 to 214
+)
+
+rndmGenSvc = RndmGenSvc("RndmGenSvc",
+  Engine = rndmEngine.name()
+)
+
+ApplicationMgr(
+  TopAlg = [gen, hepmc2edm, geantsim, podiooutput],
+  EvtSel = 'NONE',
+  EvtMax = evtMax,
+  # order is important, as GeoSvc is needed by SimG4Svc
+  ExtSvc = [rndmEngine, rndmGenSvc, dataservice, geoservice, geantservice]
+)
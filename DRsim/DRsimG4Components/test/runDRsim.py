@@ -25,6 +25,10 @@ smearTool = FlatSmearVertex("VertexSmearingTool",
   beamDirection = 0 # 1, 0, -1
 )
 
+# run & event numbers of the output, DigiSiPM keys its random streams by them
+from Configurables import EventHeaderCreator
+eventHeader = EventHeaderCreator("EventHeaderCreator", runNumber = 1, eventNumberOffset = 0)
+
 from Configurables import HepMCToEDMConverter
 hepmc2edm = HepMCToEDMConverter("Converter")
 
@@ -86,7 +90,7 @@ rndmGenSvc = RndmGenSvc("RndmGenSvc",
 )
 
 ApplicationMgr(
-  TopAlg = [gen, hepmc2edm, geantsim, podiooutput],
+  TopAlg = [eventHeader, gen, hepmc2edm, geantsim, podiooutput],
   EvtSel = 'NONE',
   EvtMax = 10,
   # order is important, as GeoSvc is needed by SimG4Svc
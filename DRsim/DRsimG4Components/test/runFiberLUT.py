@@ -0,0 +1,84 @@
+from Gaudi.Configuration import *
+from Configurables import ApplicationMgr
+from GaudiKernel import SystemOfUnits as units
+
+from Configurables import k4DataSvc
+dataservice = k4DataSvc("EventDataSvc")
+
+from Configurables import GenAlg, MomentumRangeParticleGun
+pgun = MomentumRangeParticleGun("PGun",
+  PdgCodes=[11], # electron
+  MomentumMin = 20.*units.GeV, # GeV
+  MomentumMax = 20.*units.GeV, # GeV
+  ThetaMin = 1.5335, # rad
+  ThetaMax = 1.5335, # rad
+  PhiMin = 0.01745, # rad
+  PhiMax = 0.01745 # rad
+)
+
+from Configurables import FlatSmearVertex
+smearTool = FlatSmearVertex("VertexSmearingTool",
+  yVertexMin = -36.42, # mm
+  yVertexMax = -26.42, # mm
+  zVertexMin = -52.135, # mm
+  zVertexMax = -42.135, # mm
+  beamDirection = 0 # 1, 0, -1
+)
+
+from Configurables import HepMCToEDMConverter
+hepmc2edm = HepMCToEDMConverter("Converter")
+
+gen = GenAlg("ParticleGun", SignalProvider=pgun, VertexSmearingTool=smearTool)
+
+from Configurables import GeoSvc
+geoservice = GeoSvc(
+  "GeoSvc",
+  detectors = [
+    'file:share/compact/DRcalo.xml'
+  ]
+)
+
+# full tracking of optical photons, no fast simulation
+from Configurables import SimG4Svc, SimG4OpticalPhysicsList
+opticalPhysicsTool = SimG4OpticalPhysicsList("opticalPhysics", fullphysics="SimG4FtfpBert")
+
+# the table holds the transport only, keep applyPDE = True so that the SiPM surface detects every arriving photon
+from Configurables import SimG4DRcaloActions
+actionTool = SimG4DRcaloActions("SimG4DRcaloActions",
+  fiberLUTOutput = "fiberLUT.txt"
+)
+
+# Name of the tool in GAUDI is "XX/YY" where XX is the tool class name and YY is the given name
+geantservice = SimG4Svc("SimG4Svc",
+  physicslist = opticalPhysicsTool,
+  actions = actionTool
+)
+
+from Configurables import SimG4Alg, SimG4PrimariesFromEdmTool
+# next, create the G4 algorithm, giving the list of names of tools ("XX/YY")
+edmConverter = SimG4PrimariesFromEdmTool("EdmConverter")
+
+geantsim = SimG4Alg("SimG4Alg",
+  outputs = [],
+  eventProvider = edmConverter
+)
+
+from Configurables import RndmGenSvc, HepRndm__Engine_CLHEP__RanluxEngine_
+rndmEngine = HepRndm__Engine_CLHEP__RanluxEngine_("RndmGenSvc.Engine",
+  SetSingleton = True,
+  UseTable = True,
+  Column = 0, # 0 or 1
+  Row = 123 # 0 to 214
+)
+
+rndmGenSvc = RndmGenSvc("RndmGenSvc",
+  Engine = rndmEngine.name()
+)
+
+ApplicationMgr(
+  TopAlg = [gen, hepmc2edm, geantsim],
+  EvtSel = 'NONE',
+  EvtMax = 100,
+  # order is important, as GeoSvc is needed by SimG4Svc
+  ExtSvc = [rndmEngine, rndmGenSvc, dataservice, geoservice, geantservice]
+)
@@ -0,0 +1,59 @@
+# scans the production cuts of the DRcalo regions: runs runRegionCuts.py with each setting below
+# & compares the events/s and the p.e. & energy deposit resolution to the first setting (compareSimulation)
+# usage: python scanRegionCuts.py [number of events]
+import os
+import re
+import subprocess
+import sys
+
+# name, absorber, fiber & SiPM region production cuts in mm (None keeps the cut of the compact file)
+settings = [
+  ("default", None, None, None),
+  ("absorber1mm", 1., None, None),
+  ("absorber3mm", 3., None, None),
+  ("absorber10mm", 10., None, None),
+  ("absorber3mm_sipm1mm", 3., None, 1.)
+]
+
+evtMax = sys.argv[1] if len(sys.argv) > 1 else "100"
+testDir = os.path.dirname(os.path.abspath(__file__))
+timePattern = re.compile(r"SimG4DRcaloRunAction: run .* ([0-9.eE+-]+) s \(wall clock\)")
+
+results = []
+
+for name, absorberCut, fiberCut, sipmCut in settings:
+  env = dict(os.environ, DRCALO_OUTPUT = "sim_" + name + ".root", DRCALO_EVTMAX = evtMax)
+
+  for key, cut in [("DRCALO_ABSORBER_CUT", absorberCut), ("DRCALO_FIBER_CUT", fiberCut), ("DRCALO_SIPM_CUT", sipmCut)]:
+    env.pop(key, None)
+
+    if cut is not None:
+      env[key] = str(cut)
+
+  log = subprocess.run(["k4run", os.path.join(testDir, "runRegionCuts.py")], env = env,
+                       stdout = subprocess.PIPE, stderr = subprocess.STDOUT, universal_newlines = True).stdout
+
+  with open("sim_" + name + ".log", "w") as logFile:
+    logFile.write(log)
+
+  found = timePattern.search(log)
+
+  if not found:
+    print("%s: no time per event in sim_%s.log, skipped" % (name, name))
+    continue
+
+  results.append((name, float(found.group(1))))
+
+if not results:
+  sys.exit(1)
+
+reference, referenceTime = results[0]
+
+for name, time in results:
+  print("==== %s: %.4g events/s" % (name, 1./time))
+
+  if name == reference:
+    continue
+
+  sys.stdout.flush()
+  subprocess.run(["compareSimulation", "sim_" + reference + ".root", "sim_" + name + ".root", str(referenceTime), str(time)])
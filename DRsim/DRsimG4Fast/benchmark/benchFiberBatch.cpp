@@ -0,0 +1,180 @@
+#include "FiberBatchTransport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// compares the batch transport against the reflection-by-reflection transport of a photon in a fiber,
+// which is what the tracking (and FastSimModelOpFiber, until its first transport) does for a trapped photon
+// units are mm, ns
+
+namespace {
+  const double kRadius = 0.49; // core of the Cherenkov fiber
+  const double kHalfZ = 1000.;
+  const double kNcore = 1.49;
+  const double kNclad = 1.42;
+  const double kAbsLength = 5000.;
+  const double kVelocity = 299.792458/kNcore;
+  const double kReflectivity = 0.9;
+
+  struct Photon {
+    double x, y, z;
+    double dx, dy, dz;
+    double time;
+  };
+
+  // photons uniform in the core & isotropic, kept if totally reflected at the core/cladding boundary
+  std::vector<Photon> generate(size_t num, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> flat(0.,1.);
+    std::vector<Photon> photons;
+    photons.reserve(num);
+
+    while ( photons.size() < num ) {
+      double r = kRadius*std::sqrt(flat(rng));
+      double phi = 2.*M_PI*flat(rng);
+      double cosTheta = 2.*flat(rng) - 1.;
+      double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+      double dphi = 2.*M_PI*flat(rng);
+
+      Photon photon{ r*std::cos(phi), r*std::sin(phi), kHalfZ*(2.*flat(rng) - 1.),
+                     sinTheta*std::cos(dphi), sinTheta*std::sin(dphi), cosTheta, 0. };
+
+      double beta = kNcore*photon.dz;
+      double angMom = kNcore*( photon.x*photon.dy - photon.y*photon.dx );
+
+      if ( beta*beta + angMom*angMom/(kRadius*kRadius) > kNclad*kNclad && std::abs(photon.dz) > 1e-3 )
+        photons.push_back(photon);
+    }
+
+    return photons;
+  }
+
+  // returns the path length to the SiPM (negative if lost at the dark end), counts the reflections
+  double traceReflections(Photon photon, bool hasMirror, double& reflectivity, unsigned long& nReflections) {
+    double path = 0.;
+    reflectivity = 1.;
+
+    for (unsigned long iStep = 0; iStep < 10000000; iStep++) {
+      double a = photon.dx*photon.dx + photon.dy*photon.dy;
+      double b = photon.x*photon.dx + photon.y*photon.dy;
+      double c = std::min( photon.x*photon.x + photon.y*photon.y - kRadius*kRadius, 0. );
+      double toWall = ( -b + std::sqrt( std::max( b*b - a*c, 0. ) ) )/a;
+      double toEnd = ( photon.dz > 0. ) ? ( kHalfZ - photon.z )/photon.dz : ( -kHalfZ - photon.z )/photon.dz;
+
+      if ( toEnd <= toWall ) {
+        path += toEnd;
+        photon.z += toEnd*photon.dz;
+
+        if ( photon.dz > 0. )
+          return path;
+
+        if ( !hasMirror )
+          return -1.;
+
+        photon.x += toEnd*photon.dx;
+        photon.y += toEnd*photon.dy;
+        photon.dz = -photon.dz;
+        reflectivity *= kReflectivity;
+        continue;
+      }
+
+      path += toWall;
+      photon.x += toWall*photon.dx;
+      photon.y += toWall*photon.dy;
+      photon.z += toWall*photon.dz;
+
+      // keep the photon on the wall against the rounding
+      double r = std::sqrt( photon.x*photon.x + photon.y*photon.y );
+      photon.x *= kRadius/r;
+      photon.y *= kRadius/r;
+
+      double nx = photon.x/kRadius;
+      double ny = photon.y/kRadius;
+      double proj = photon.dx*nx + photon.dy*ny;
+      photon.dx -= 2.*proj*nx;
+      photon.dy -= 2.*proj*ny;
+      nReflections++;
+    }
+
+    return -1.;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  size_t num = argc > 1 ? std::stoul(argv[1]) : 10000;
+  size_t numFibers = argc > 2 ? std::stoul(argv[2]) : 1000;
+  bool hasMirror = argc > 3 ? std::stoi(argv[3])!=0 : true;
+
+  std::mt19937_64 rng(12345);
+  std::vector<Photon> photons = generate(num, rng);
+
+  std::vector<double> rands(num);
+  std::uniform_real_distribution<double> flat(0.,1.);
+  for (auto& val : rands)
+    val = flat(rng);
+
+  // reflection by reflection
+  auto start = std::chrono::steady_clock::now();
+
+  unsigned long nReflections = 0;
+  size_t nArrivedScalar = 0;
+  double sumTimeScalar = 0.;
+
+  for (size_t idx = 0; idx < num; idx++) {
+    double reflectivity = 1.;
+    double path = traceReflections(photons.at(idx), hasMirror, reflectivity, nReflections);
+
+    if ( path < 0. || rands.at(idx) >= std::exp(-path/kAbsLength)*reflectivity )
+      continue;
+
+    nArrivedScalar++;
+    sumTimeScalar += photons.at(idx).time + path/kVelocity;
+  }
+
+  double timeScalar = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+  // batch
+  start = std::chrono::steady_clock::now();
+
+  FiberBatchTransport engine;
+
+  for (size_t idx = 0; idx < num; idx++) {
+    const auto& photon = photons.at(idx);
+    engine.add( idx%numFibers, kHalfZ, hasMirror, photon.z, photon.dz, photon.time, 1./kAbsLength, 1./kVelocity, kReflectivity, 3.e-6 );
+  }
+
+  // same random numbers as above, the key is the fiber & its photons are added in order
+  size_t nArrivedBatch = 0;
+  double sumTimeBatch = 0.;
+
+  engine.transport(
+    [&](std::uint64_t fiber, size_t n, double* buffer) {
+      for (size_t iPhoton = 0; iPhoton < n; iPhoton++)
+        buffer[iPhoton] = rands.at( fiber + iPhoton*numFibers );
+    },
+    [&](std::uint64_t, const FiberBatchTransport::Arrival& arrival) {
+      nArrivedBatch += arrival.size();
+
+      for (size_t iPhoton = 0; iPhoton < arrival.size(); iPhoton++)
+        sumTimeBatch += arrival.time.at(iPhoton);
+    }
+  );
+
+  double timeBatch = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+  std::cout << "photons " << num << " fibers " << numFibers << " mirror " << hasMirror << std::endl;
+  std::cout << "  reflection by reflection : " << timeScalar << " s, " << static_cast<double>(num)/timeScalar << " photons/s, "
+            << static_cast<double>(nReflections)/static_cast<double>(num) << " reflections/photon" << std::endl;
+  std::cout << "  batch                    : " << timeBatch << " s, " << static_cast<double>(num)/timeBatch << " photons/s" << std::endl;
+  std::cout << "  speedup " << timeScalar/timeBatch << std::endl;
+  std::cout << "  arrived " << nArrivedScalar << " vs " << nArrivedBatch
+            << ", mean arrival time " << sumTimeScalar/static_cast<double>(std::max(nArrivedScalar,size_t(1)))
+            << " vs " << sumTimeBatch/static_cast<double>(std::max(nArrivedBatch,size_t(1))) << " ns" << std::endl;
+
+  return 0;
+}
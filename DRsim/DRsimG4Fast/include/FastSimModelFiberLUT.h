@@ -0,0 +1,40 @@
+#ifndef FastSimModelFiberLUT_h
+#define FastSimModelFiberLUT_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "G4Tubs.hh"
+#include "G4LogicalVolume.hh"
+
+#include "DRcaloFiberLUT.h"
+#include "DRcaloSiPMSD.h"
+
+#include <unordered_map>
+
+// Replaces the whole tracking of an optical photon born in a fiber core:
+// survival & arrival time are sampled from the lookup table and the photon is written directly to the SiPM hit
+class FastSimModelFiberLUT : public G4VFastSimulationModel {
+public:
+  FastSimModelFiberLUT(G4String name, G4Region* envelope, const drc::DRcaloFiberLUT* lut, const G4String& sdName);
+  ~FastSimModelFiberLUT();
+
+  virtual G4bool IsApplicable(const G4ParticleDefinition&);
+  virtual G4bool ModelTrigger(const G4FastTrack&);
+  virtual void DoIt(const G4FastTrack&, G4FastStep&);
+
+private:
+  struct LUTFiber {
+    const G4Tubs* tubs = nullptr; // nullptr if not a fiber core
+    G4bool isCerenkov = false;
+  };
+
+  const LUTFiber& fiber(const G4LogicalVolume* lv);
+  drc::DRcaloSiPMSD* sensitiveDetector();
+
+  const drc::DRcaloFiberLUT* pLUT;
+  drc::DRcaloSiPMSD* pSD;
+  G4String fSDName;
+
+  std::unordered_map<const G4LogicalVolume*, LUTFiber> mFibers;
+};
+
+#endif
@@ -8,6 +8,19 @@
 #include "G4OpAbsorption.hh"
 #include "G4OpWLS.hh"
 #include "G4Material.hh"
+#include "G4Tubs.hh"
+#include "G4LogicalVolume.hh"
+#include "G4MaterialPropertyVector.hh"
+
+#include "FiberBatchTransport.h"
+#include "DRcaloSiPMSD.h"
+#include "DRcaloRandom.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 struct FastFiberData {
 public:
@@ -45,6 +58,37 @@ private:
   G4double mStepLengthInterval;
 };
 
+// geometry & optical properties of a fiber volume, cached per logical volume
+struct FastFiberGeometry {
+  const G4Tubs* tubs = nullptr; // nullptr if the volume is not a G4Tubs
+  G4bool isCore = false;
+  G4bool hasMirror = false; // the -z end of the fiber is terminated by the mirror
+  G4MaterialPropertyVector* mirrorReflectivity = nullptr;
+  G4MaterialPropertyVector* absLength = nullptr;
+  G4MaterialPropertyVector* wlsAbsLength = nullptr;
+};
+
+// hot-path counters of a model, only the thread owning the model increments them
+struct FastFiberCounters {
+  enum Reject { kNoTIR = 0, kNoTubs, kSafety, kWLS, kNumReject };
+
+  unsigned long calls = 0; // ModelTrigger calls with the model switched on
+  unsigned long triggered = 0;
+  std::array<unsigned long, kNumReject> rejected{};
+  unsigned long transported = 0;
+  unsigned long killed = 0; // absorbed before the fiber end
+  unsigned long batched = 0;
+  unsigned long nillResets = 0;
+  double savedReflections = 0.;
+
+  // transported axial length, off if there is no bin
+  std::vector<unsigned long> lengthHist;
+  double lengthMax = 0.;
+
+  void fillLength(G4double length);
+  FastFiberCounters& operator+=(const FastFiberCounters& other);
+};
+
 class FastSimModelOpFiber : public G4VFastSimulationModel {
 public:
   FastSimModelOpFiber(G4String, G4Region*);
@@ -54,6 +98,16 @@ public:
   virtual G4bool ModelTrigger(const G4FastTrack&);
   virtual void DoIt(const G4FastTrack&, G4FastStep&);
 
+  void setOneShot(G4bool oneShot) { fOneShot = oneShot; }
+
+  // gather trapped photons and transport them in batch at the end of the event, delivered to the SD sdName
+  void setBatch(G4bool batch, const G4String& sdName);
+  // seed of the counter-based streams of the batches, one per event & fiber
+  void setSeed(std::uint64_t seed) { fSeed = seed; }
+
+  void setLengthHist(G4int nBins, G4double lengthMax);
+  const FastFiberCounters& counters() const { return mCounters; }
+
 private:
   void DefineCommands();
 
@@ -61,6 +115,17 @@ private:
   G4bool checkAbsorption(const G4double prevNILL, const G4double currentNILL);
   G4bool checkNILL();
 
+  // one-shot transport of the trapped photon to the fiber end at its first total internal reflection
+  G4bool oneShotTrigger(const G4Track* track);
+  void oneShotDoIt(const G4Track* track, G4FastStep& faststep);
+
+  // push the trapped photon to the batch of its fiber
+  void batchDoIt(const G4Track* track, G4FastStep& faststep);
+  void flushBatch();
+  drc::DRcaloSiPMSD* sensitiveDetector();
+
+  const FastFiberGeometry& fiberGeometry(const G4VTouchable* touchable);
+
   void setPostStepProc(const G4Track* track);
   void reset();
   void print();
@@ -83,6 +148,24 @@ private:
   G4bool fKill;
   G4bool fTransported;
 
+  std::unordered_map<const G4LogicalVolume*, FastFiberGeometry> mFiberGeometries;
+
+  // result of the one-shot transport in the global frame
+  G4ThreeVector mOneShotPos;
+  G4ThreeVector mOneShotDir;
+  G4double mOneShotTime;
+  G4double mOneShotSurvival;
+  G4bool fOneShot;
+
+  std::unique_ptr<FiberBatchTransport> mBatch;
+  drc::DRcaloSiPMSD* pSD;
+  G4String fSDName;
+  std::uint64_t fSeed;
+
+  FastFiberCounters mCounters;
+  G4double mTransportLength; // axial length & reflections saved by the transport about to be done
+  G4double mSavedReflections;
+
   G4bool fSwitch;
   G4int fVerbose;
 };
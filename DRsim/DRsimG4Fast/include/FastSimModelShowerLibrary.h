@@ -0,0 +1,55 @@
+#ifndef FastSimModelShowerLibrary_h
+#define FastSimModelShowerLibrary_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "G4Navigator.hh"
+#include "G4TouchableHistory.hh"
+
+#include "DRcaloShowerLibrary.h"
+#include "DRcaloSiPMSD.h"
+
+#include <memory>
+#include <vector>
+
+// Replaces the shower of an electron or a photon entering a tower by a shower of the library:
+// the SiPM offsets of the library shower are rotated to the azimuth of the particle around the tower axis
+// & translated to its entry point, each point is located in the tower in front of it
+// the photon counts are scaled by the energy ratio and written directly to the SiPM hits
+class FastSimModelShowerLibrary : public G4VFastSimulationModel {
+public:
+  FastSimModelShowerLibrary(G4String name, G4Region* envelope, const drc::DRcaloShowerLibrary* library, const G4String& sdName);
+  ~FastSimModelShowerLibrary();
+
+  virtual G4bool IsApplicable(const G4ParticleDefinition&);
+  virtual G4bool ModelTrigger(const G4FastTrack&);
+  virtual void DoIt(const G4FastTrack&, G4FastStep&);
+
+  void setEnergyThreshold(G4double threshold) { fThreshold = threshold; }
+
+  G4long showers() const { return mShowers; }
+  G4long missing() const { return mMissing; }
+
+private:
+  drc::DRcaloSiPMSD* sensitiveDetector();
+
+  // history of the point in the tower frame, nullptr if the point is not inside a tower
+  const G4NavigationHistory* locateTower(const G4ThreeVector& global, G4bool relative);
+
+  const drc::DRcaloShowerLibrary* pLibrary;
+  drc::DRcaloSiPMSD* pSD;
+  G4String fSDName;
+  G4double fThreshold;
+
+  std::unique_ptr<G4Navigator> fNavigator; // not the tracking navigator, its state must not change
+  G4TouchableHistory fTouchable;
+
+  // photons of a SiPM
+  std::vector<G4double> mTimes;
+  std::vector<G4double> mEnergies;
+  std::vector<G4int> mWeights;
+
+  G4long mShowers;
+  G4long mMissing; // no shower in the library
+};
+
+#endif
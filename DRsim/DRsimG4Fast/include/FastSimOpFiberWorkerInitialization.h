@@ -0,0 +1,26 @@
+#ifndef FastSimOpFiberWorkerInitialization_h
+#define FastSimOpFiberWorkerInitialization_h 1
+
+#include "G4UserWorkerInitialization.hh"
+
+#include <functional>
+
+// Builds the fast simulation models of a worker thread before it tracks anything
+// the worker initialization already given to the run manager (if any) is chained and owned by this one
+class FastSimOpFiberWorkerInitialization : public G4UserWorkerInitialization {
+public:
+  FastSimOpFiberWorkerInitialization(std::function<void()> build, const G4UserWorkerInitialization* chained);
+  virtual ~FastSimOpFiberWorkerInitialization();
+
+  virtual void WorkerInitialize() const;
+  virtual void WorkerStart() const;
+  virtual void WorkerStartRun() const;
+  virtual void WorkerRunEnd() const;
+  virtual void WorkerStop() const;
+
+private:
+  std::function<void()> fBuild; // must be idempotent per thread
+  const G4UserWorkerInitialization* pChained;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef FiberBatchTransport_h
+#define FiberBatchTransport_h 1
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Batch transport of the optical photons trapped in fiber cores
+// photons are gathered per fiber into SoA buffers and propagated to the fiber end in a single branch-free loop,
+// a totally reflected ray travels (axial distance)/|cos(theta)| whatever the number of reflections is
+// the engine is free of GEANT4 so that it can be benchmarked standalone, units are up to the caller
+class FiberBatchTransport {
+public:
+  struct Batch {
+    std::uint64_t key = 0; // e.g. cell ID of the SiPM
+    double halfZ = 0.; // half length of the fiber core
+    bool hasMirror = false; // false if the -z end is dark
+
+    // SoA of the photons in the local frame of the core, z is the axis toward the SiPM
+    std::vector<double> z;
+    std::vector<double> dirZ;
+    std::vector<double> time;
+    std::vector<double> invAbsLength;
+    std::vector<double> invVelocity;
+    std::vector<double> mirrorReflectivity;
+    std::vector<double> energy;
+    std::vector<int> weight;
+
+    size_t size() const { return z.size(); }
+  };
+
+  // arrived photons of a fiber
+  struct Arrival {
+    std::vector<double> time;
+    std::vector<double> energy;
+    std::vector<int> weight;
+
+    size_t size() const { return time.size(); }
+  };
+
+  FiberBatchTransport() {}
+  ~FiberBatchTransport() {}
+
+  void add(std::uint64_t key, double halfZ, bool hasMirror, double z, double dirZ, double time,
+           double invAbsLength, double invVelocity, double mirrorReflectivity, double energy, int weight = 1);
+
+  size_t size() const { return fSize; }
+
+  // propagate every batch and deliver the survivors fiber by fiber in the order of the first photon of each fiber
+  // flat(key, n, buffer) fills the buffer with n uniform random numbers in (0,1) from the stream of the fiber
+  void transport(const std::function<void(std::uint64_t, size_t, double*)>& flat,
+                 const std::function<void(std::uint64_t, const Arrival&)>& deliver);
+
+  void clear();
+
+  // propagate the batch & keep the survivors, rand holds a uniform random number per photon
+  static void transportBatch(const Batch& batch, const double* rand, std::vector<double>& arrivalTime,
+                             std::vector<double>& survival, Arrival& arrival);
+
+  // kernel, arrival time & survival probability of n photons of the same fiber
+  static void propagate(size_t n, double halfZ, bool hasMirror, const double* z, const double* dirZ, const double* time,
+                        const double* invAbsLength, const double* invVelocity, const double* mirrorReflectivity,
+                        double* arrival, double* survival);
+
+private:
+  std::vector<Batch> fBatches;
+  std::unordered_map<std::uint64_t, size_t> fIndex;
+  size_t fSize = 0;
+
+  // scratch buffers reused over the batches
+  std::vector<double> fRand;
+  std::vector<double> fArrivalTime;
+  std::vector<double> fSurvival;
+  Arrival fArrival;
+};
+
+#endif
@@ -4,10 +4,15 @@
 #include <vector>
 #include <iostream>
 #include <memory>
+#include <map>
 
 #include "FastSimModelOpFiber.h"
+#include "FastSimModelFiberLUT.h"
+#include "DRcaloFiberLUT.h"
 
 #include "G4LogicalVolume.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
 
 #include "GaudiAlg/GaudiTool.h"
 #include "GaudiKernel/ToolHandle.h"
@@ -28,9 +33,31 @@ public:
   virtual StatusCode create() final;
 
 private:
-  std::unique_ptr<FastSimModelOpFiber> m_model;
+  // models of a thread, the tracking state of a model must not be shared between threads
+  struct ThreadModels {
+    std::unique_ptr<FastSimModelOpFiber> model;
+    std::unique_ptr<FastSimModelFiberLUT> lutModel;
+  };
+
+  // build the models of the calling thread (once), the master keeps its own for the UI commands broadcast to the workers
+  void buildModels();
+
+  // sum the counters of the models of every thread & print them, called at the end of the job
+  void printCounters();
+
+  std::map<G4int, ThreadModels> m_models; // by G4 thread ID
+  G4Mutex m_mutex = G4MUTEX_INITIALIZER;
+
+  std::unique_ptr<drc::DRcaloFiberLUT> m_lut; // read-only, shared by the threads
 
   Gaudi::Property<std::string> m_regionName{this, "regionName", "FastSimOpFiberRegion", "fast fiber region name"};
+  Gaudi::Property<std::string> m_fiberLUT{this, "fiberLUT", "", "Fiber response lookup table for the photons born in the fiber cores (empty to switch off)"};
+  Gaudi::Property<std::string> m_sdName{this, "sensitiveDetector", "DRcalo", "Name of the DRcaloSiPMSD to which the lookup table model writes photons"};
+  Gaudi::Property<bool> m_batch{this, "batch", false, "Gather trapped photons per fiber and transport them in batch at the end of the event"};
+  Gaudi::Property<int> m_lengthHistBins{this, "lengthHistBins", 0, "Number of bins of the histogram of the transported axial length (0 to switch off)"};
+  Gaudi::Property<double> m_lengthHistMax{this, "lengthHistMax", 6000., "Upper edge of the histogram of the transported axial length [mm]"};
+  Gaudi::Property<unsigned long> m_seed{this, "seed", 0, "Seed of the random streams of the batch transport, mixed with the run & event IDs"};
+  Gaudi::Property<bool> m_oneShot{this, "oneShot", false, "Transport trapped photons to the fiber end at the first total internal reflection"};
 };
 
 #endif
@@ -0,0 +1,47 @@
+#ifndef SimG4FastSimShowerLibraryRegion_h
+#define SimG4FastSimShowerLibraryRegion_h 1
+
+#include <memory>
+#include <map>
+
+#include "FastSimModelShowerLibrary.h"
+#include "DRcaloShowerLibrary.h"
+
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+
+#include "GaudiAlg/GaudiTool.h"
+#include "GaudiKernel/SystemOfUnits.h"
+#include "k4Interface/ISimG4RegionTool.h"
+
+class G4Region;
+
+class SimG4FastSimShowerLibraryRegion : public GaudiTool, virtual public ISimG4RegionTool {
+public:
+  explicit SimG4FastSimShowerLibraryRegion(const std::string& type, const std::string& name, const IInterface* parent);
+  virtual ~SimG4FastSimShowerLibraryRegion();
+
+  virtual StatusCode initialize() final;
+  virtual StatusCode finalize() final;
+
+  virtual StatusCode create() final;
+
+private:
+  // the region of the towers, made of the tower volumes unless it is defined by the geometry
+  G4Region* towerRegion();
+
+  // build the model of the calling thread (once)
+  void buildModel();
+
+  std::map<G4int, std::unique_ptr<FastSimModelShowerLibrary>> m_models; // by G4 thread ID
+  G4Mutex m_mutex = G4MUTEX_INITIALIZER;
+
+  std::unique_ptr<drc::DRcaloShowerLibrary> m_library; // read-only, shared by the threads
+
+  Gaudi::Property<std::string> m_regionName{this, "regionName", "DRcaloAbsorberRegion", "Region of the towers (created from the tower volumes if it does not exist)"};
+  Gaudi::Property<std::string> m_showerLibrary{this, "showerLibrary", "", "Shower library recorded by SimG4DRcaloActions::showerLibraryOutput"};
+  Gaudi::Property<std::string> m_sdName{this, "sensitiveDetector", "DRcalo", "Name of the DRcaloSiPMSD to which the library showers are written"};
+  Gaudi::Property<double> m_threshold{this, "energyThreshold", 1.*Gaudi::Units::GeV, "Electrons & photons entering a tower above this kinetic energy are replaced by a library shower"};
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "FastSimModelFiberLUT.h"
+
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTypes.hh"
+#include "G4SDManager.hh"
+#include "G4NavigationHistory.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+#include <stdexcept>
+
+FastSimModelFiberLUT::FastSimModelFiberLUT(G4String name, G4Region* envelope, const drc::DRcaloFiberLUT* lut, const G4String& sdName)
+: G4VFastSimulationModel(name,envelope), pLUT(lut), pSD(nullptr), fSDName(sdName) {}
+
+FastSimModelFiberLUT::~FastSimModelFiberLUT() {}
+
+G4bool FastSimModelFiberLUT::IsApplicable(const G4ParticleDefinition& type) {
+  return &type == G4OpticalPhoton::OpticalPhotonDefinition();
+}
+
+G4bool FastSimModelFiberLUT::ModelTrigger(const G4FastTrack& fasttrack) {
+  const G4Track* track = fasttrack.GetPrimaryTrack();
+
+  // photons born in this volume only
+  if ( track->GetCurrentStepNumber() > 1 )
+    return false;
+
+  return fiber( track->GetVolume()->GetLogicalVolume() ).tubs!=nullptr && track->GetTouchable()->GetHistoryDepth() > 2;
+}
+
+void FastSimModelFiberLUT::DoIt(const G4FastTrack& fasttrack, G4FastStep& faststep) {
+  const G4Track* track = fasttrack.GetPrimaryTrack();
+  const G4VTouchable* touchable = track->GetTouchable();
+  const LUTFiber& theFiber = fiber( track->GetVolume()->GetLogicalVolume() );
+
+  const G4AffineTransform& toLocal = touchable->GetHistory()->GetTopTransform();
+  G4ThreeVector pos = toLocal.TransformPoint( track->GetPosition() );
+  G4ThreeVector dir = toLocal.TransformAxis( track->GetMomentumDirection() );
+  G4double energy = track->GetTotalEnergy();
+  G4double wavlen = h_Planck*c_light/energy;
+  G4double dist = pLUT->unfoldedDistance( pos.z()/mm, theFiber.tubs->GetZHalfLength()/mm, dir.z() );
+
+  auto resp = pLUT->response( theFiber.isCerenkov, dist, dir.z(), wavlen/nm );
+
+  faststep.ProposeTotalEnergyDeposited(track->GetKineticEnergy());
+  faststep.KillPrimaryTrack();
+
+  if ( G4UniformRand() >= resp.survival )
+    return;
+
+  G4double delay = std::max( G4RandGauss::shoot(resp.meanTime,resp.rmsTime), 0. )*ns;
+  G4int weight = static_cast<G4int>( std::lround( track->GetWeight() ) ); // weighted optical photons
+
+  auto* sd = sensitiveDetector();
+  sd->addPhoton( sd->fiberCellID(touchable), track->GetGlobalTime()+delay, energy, weight );
+}
+
+const FastSimModelFiberLUT::LUTFiber& FastSimModelFiberLUT::fiber(const G4LogicalVolume* lv) {
+  auto found = mFibers.find(lv);
+
+  if ( found!=mFibers.end() )
+    return found->second;
+
+  LUTFiber theFiber;
+  const G4String& name = lv->GetName();
+
+  if ( name.rfind("coreC",0)==0 || name.rfind("coreS",0)==0 ) {
+    theFiber.tubs = dynamic_cast<const G4Tubs*>( lv->GetSolid() );
+    theFiber.isCerenkov = ( name.rfind("coreC",0)==0 );
+  }
+
+  return mFibers.emplace(lv,theFiber).first->second;
+}
+
+drc::DRcaloSiPMSD* FastSimModelFiberLUT::sensitiveDetector() {
+  if (pSD)
+    return pSD;
+
+  // SDs are thread-local, look up the one of this thread
+  pSD = dynamic_cast<drc::DRcaloSiPMSD*>( G4SDManager::GetSDMpointer()->FindSensitiveDetector(fSDName,false) );
+
+  if (!pSD)
+    throw std::runtime_error("FastSimModelFiberLUT: unable to find DRcaloSiPMSD " + fSDName);
+
+  return pSD;
+}
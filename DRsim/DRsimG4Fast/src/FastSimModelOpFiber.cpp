@@ -6,6 +6,20 @@
 #include "G4OpProcessSubType.hh"
 #include "G4GeometryTolerance.hh"
 #include "G4Tubs.hh"
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+#include "G4LogicalSkinSurface.hh"
+#include "G4OpticalSurface.hh"
+#include "G4SDManager.hh"
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 FastFiberData::FastFiberData(G4int id, G4double en, G4double globTime, G4double path, G4ThreeVector pos, G4ThreeVector mom, G4ThreeVector pol, G4int status) {
   trackID = id;
@@ -73,11 +87,22 @@ FastSimModelOpFiber::FastSimModelOpFiber(G4String name, G4Region* envelope)
   fTransported = false;
   fSwitch = true;
   fVerbose = 0;
+  mOneShotPos = G4ThreeVector(0);
+  mOneShotDir = G4ThreeVector(0);
+  mOneShotTime = 0.;
+  mOneShotSurvival = 1.;
+  fOneShot = false;
+  pSD = nullptr;
+  fSeed = 0;
+  mTransportLength = 0.;
+  mSavedReflections = 0.;
 
   DefineCommands();
 }
 
-FastSimModelOpFiber::~FastSimModelOpFiber() {}
+FastSimModelOpFiber::~FastSimModelOpFiber() {
+  delete mMessenger;
+}
 
 G4bool FastSimModelOpFiber::IsApplicable(const G4ParticleDefinition& type) {
   return &type == G4OpticalPhoton::OpticalPhotonDefinition();
@@ -88,14 +113,28 @@ G4bool FastSimModelOpFiber::ModelTrigger(const G4FastTrack& fasttrack) {
     return false; // turn on/off the model
 
   const G4Track* track = fasttrack.GetPrimaryTrack();
+  mCounters.calls++;
+
+  if ( fOneShot || mBatch ) {
+    G4bool trigger = oneShotTrigger(track);
+
+    if (trigger)
+      mCounters.triggered++;
+
+    return trigger;
+  }
 
   // reset when moving to the next track
   if ( mDataCurrent.trackID != track->GetTrackID() )
     reset();
 
   // make sure that the track does not get absorbed after transportation, as number of interaction length left is reset when doing transportation
-  if (!checkNILL())
+  if (!checkNILL()) {
+    mCounters.nillResets++;
+    mCounters.triggered++;
+
     return true; // track is already transported but did not pass NILL check, attempt to reset NILL
+  }
 
   if (fTransported) { // track is already transported and did pass NILL check, nothing to do
     if ( mFiberAxis.dot(track->GetMomentumDirection())*mFiberAxis.dot(mDataCurrent.momentumDirection) < 0 ) // different propagation direction (e.g. mirror)
@@ -104,23 +143,29 @@ G4bool FastSimModelOpFiber::ModelTrigger(const G4FastTrack& fasttrack) {
     return false;
   }
 
-  if ( !checkTotalInternalReflection(track) )
+  if ( !checkTotalInternalReflection(track) ) {
+    mCounters.rejected[FastFiberCounters::kNoTIR]++;
+
     return false; // nothing to do if the track has no repetitive total internal reflection
+  }
 
   auto theTouchable = track->GetTouchableHandle();
-  auto solid = theTouchable->GetSolid();
+  const FastFiberGeometry& geometry = fiberGeometry( theTouchable() );
+
+  if ( !geometry.tubs ) {
+    mCounters.rejected[FastFiberCounters::kNoTubs]++;
 
-  if ( solid->GetEntityType()!="G4Tubs" )
     return false; // only works for G4Tubs at the moment
+  }
 
   if (fVerbose>0)
     print(); // at this point, the track should have passed all prerequisites before entering computationally heavy operations
 
-  G4Tubs* tubs = static_cast<G4Tubs*>(solid);
-  G4double fiberLen = 2.*tubs->GetZHalfLength();
+  G4double fiberLen = 2.*geometry.tubs->GetZHalfLength();
 
-  mFiberPos = theTouchable->GetHistory()->GetTopTransform().Inverse().TransformPoint(G4ThreeVector(0.,0.,0.));
-  mFiberAxis = theTouchable->GetHistory()->GetTopTransform().Inverse().TransformAxis(G4ThreeVector(0.,0.,1.));
+  const G4AffineTransform& toLocal = theTouchable->GetHistory()->GetTopTransform();
+  mFiberPos = toLocal.InverseTransformPoint(G4ThreeVector(0.,0.,0.));
+  mFiberAxis = toLocal.InverseTransformAxis(G4ThreeVector(0.,0.,1.));
 
   auto delta = mDataCurrent.globalPosition - mDataPrevious.globalPosition;
   mTransportUnit = delta.dot(mFiberAxis);
@@ -132,23 +177,47 @@ G4bool FastSimModelOpFiber::ModelTrigger(const G4FastTrack& fasttrack) {
   G4double maxTransport = std::floor(toEndAxis/mTransportUnit);
   mNtransport = maxTransport - fSafety;
 
-  if ( mNtransport < 1. )
+  if ( mNtransport < 1. ) {
+    mCounters.rejected[FastFiberCounters::kSafety]++;
+
     return false; // require at least n = fSafety of total internal reflections at the end
+  }
+
+  if ( checkAbsorption(mDataPrevious.GetWLSNILL(), mDataCurrent.GetWLSNILL()) ) {
+    mCounters.rejected[FastFiberCounters::kWLS]++;
 
-  if ( checkAbsorption(mDataPrevious.GetWLSNILL(), mDataCurrent.GetWLSNILL()) )
     return false; // do nothing if WLS happens before reaching fiber end
+  }
+
   if ( checkAbsorption(mDataPrevious.GetAbsorptionNILL(), mDataCurrent.GetAbsorptionNILL()) )
     fKill = true; // absorbed before reaching fiber end
 
+  mTransportLength = std::abs(mTransportUnit)*mNtransport;
+  mSavedReflections = mNtransport;
+  mCounters.triggered++;
+
   return true;
 }
 
 void FastSimModelOpFiber::DoIt(const G4FastTrack& fasttrack, G4FastStep& faststep) {
   auto track = fasttrack.GetPrimaryTrack();
 
+  if (mBatch) {
+    batchDoIt(track, faststep);
+
+    return;
+  }
+
+  if (fOneShot) {
+    oneShotDoIt(track, faststep);
+
+    return;
+  }
+
   if (fKill) { // absorption
     faststep.ProposeTotalEnergyDeposited(track->GetKineticEnergy());
     faststep.KillPrimaryTrack();
+    mCounters.killed++;
 
     return;
   }
@@ -157,7 +226,7 @@ void FastSimModelOpFiber::DoIt(const G4FastTrack& fasttrack, G4FastStep& fastste
     return; // reset NILL if the track did not meet NILL check
 
   double timeUnit = mDataCurrent.globalTime - mDataPrevious.globalTime;
-  auto posShift = mTransportUnit*mNtransport*mFiberAxis; // #TODO apply shift for xy direction as well
+  auto posShift = mTransportUnit*mNtransport*mFiberAxis; // shift along the fiber axis only, see oneShotTrigger for the exact xy position
   double timeShift = timeUnit*mNtransport;
 
   faststep.ProposePrimaryTrackFinalPosition( track->GetPosition() + posShift, false );
@@ -167,9 +236,303 @@ void FastSimModelOpFiber::DoIt(const G4FastTrack& fasttrack, G4FastStep& fastste
   faststep.ProposePrimaryTrackFinalPolarization( track->GetPolarization(), false );
   fTransported = true;
 
+  mCounters.transported++;
+  mCounters.savedReflections += mSavedReflections;
+  mCounters.fillLength(mTransportLength);
+
+  return;
+}
+
+G4bool FastSimModelOpFiber::oneShotTrigger(const G4Track* track) {
+  if (!fProcAssigned)
+    setPostStepProc(track); // locate OpBoundaryProcess only once
+
+  // status of the boundary process belongs to this track only after its first step
+  if ( pOpBoundaryProc==nullptr || track->GetCurrentStepNumber() < 2 ||
+       track->GetStep()->GetPreStepPoint()->GetStepStatus()!=fGeomBoundary ||
+       pOpBoundaryProc->GetStatus()!=G4OpBoundaryProcessStatus::TotalInternalReflection ) {
+    mCounters.rejected[FastFiberCounters::kNoTIR]++;
+
+    return false;
+  }
+
+  auto theTouchable = track->GetTouchableHandle();
+  const FastFiberGeometry& geometry = fiberGeometry( theTouchable() );
+
+  if ( !geometry.tubs || !geometry.isCore ) {
+    mCounters.rejected[FastFiberCounters::kNoTubs]++;
+
+    return false; // photons trapped in the core only
+  }
+
+  if ( geometry.wlsAbsLength ) {
+    mCounters.rejected[FastFiberCounters::kWLS]++;
+
+    return false; // leave WLS to GEANT4
+  }
+
+  const G4AffineTransform& toLocal = theTouchable->GetHistory()->GetTopTransform();
+  G4ThreeVector pos = toLocal.TransformPoint( track->GetPosition() );
+  G4ThreeVector dir = toLocal.TransformAxis( track->GetMomentumDirection() );
+
+  const G4double radius = geometry.tubs->GetOuterRadius();
+  const G4double halfZ = geometry.tubs->GetZHalfLength();
+  const G4double tolerance = G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+  const G4double transverse = std::sqrt( dir.x()*dir.x() + dir.y()*dir.y() );
+
+  if ( transverse < tolerance || std::abs(dir.z()) < tolerance )
+    return false;
+
+  if (mBatch)
+    return true; // the batch takes the photon as it is
+
+  // the projection on the transverse plane is a billiard in a circle,
+  // every chord rotates the position & direction by the same angle around the fiber axis
+  const G4double ux = dir.x()/transverse;
+  const G4double uy = dir.y()/transverse;
+  const G4double proj = pos.x()*ux + pos.y()*uy;
+  const G4double disc = std::max( proj*proj - ( pos.x()*pos.x() + pos.y()*pos.y() - radius*radius ), 0. );
+  const G4double back = proj + std::sqrt(disc); // transverse distance back to the start of the chord
+  const G4double ax = pos.x() - back*ux;
+  const G4double ay = pos.y() - back*uy;
+  const G4double cross = ax*uy - ay*ux;
+  const G4double impact = std::min( std::abs(cross), radius );
+  const G4double chord = 2.*std::sqrt( radius*radius - impact*impact );
+
+  if ( chord < tolerance )
+    return false;
+
+  const G4double angle = 2.*std::acos(impact/radius)*( cross < 0. ? -1. : 1. );
+
+  // axial length to the fiber end from the start of the chord (back and forth if heading to the mirror)
+  const G4double slope = std::abs(dir.z())/transverse;
+  const G4double startZ = pos.z() - back*dir.z()/transverse;
+  const G4double toBottom = startZ + halfZ;
+  const G4bool viaMirror = ( dir.z() < 0. && geometry.hasMirror );
+  G4double axial = ( dir.z() > 0. ) ? halfZ - startZ : toBottom;
+
+  if (viaMirror)
+    axial += 2.*halfZ;
+
+  // stop at the middle of a chord, at least a chord before the fiber end
+  const G4double nChord = std::floor( axial/slope/chord - 1.5 );
+
+  if ( nChord < 1. ) {
+    mCounters.rejected[FastFiberCounters::kSafety]++;
+
+    return false;
+  }
+
+  const G4double travel = ( nChord + 0.5 )*chord;
+  const G4double axialTravel = travel*slope;
+  const G4double pathLength = ( travel - back )/transverse;
+
+  G4double finalZ = startZ + axialTravel;
+  G4double finalDirZ = dir.z();
+  G4bool reflected = false;
+
+  if ( dir.z() < 0. ) {
+    if ( axialTravel < toBottom ) {
+      finalZ = startZ - axialTravel;
+    } else { // reflected by the mirror
+      finalZ = -halfZ + ( axialTravel - toBottom );
+      finalDirZ = -dir.z();
+      reflected = true;
+    }
+  }
+
+  const G4double cosRot = std::cos(nChord*angle);
+  const G4double sinRot = std::sin(nChord*angle);
+  const G4double mx = ax + 0.5*chord*ux;
+  const G4double my = ay + 0.5*chord*uy;
+
+  G4ThreeVector finalPos( cosRot*mx - sinRot*my, sinRot*mx + cosRot*my, finalZ );
+  G4ThreeVector finalDir( transverse*(cosRot*ux - sinRot*uy), transverse*(sinRot*ux + cosRot*uy), finalDirZ );
+
+  const G4double photonMomentum = track->GetDynamicParticle()->GetTotalMomentum();
+  mOneShotSurvival = 1.;
+
+  if ( geometry.absLength )
+    mOneShotSurvival *= std::exp( -pathLength/geometry.absLength->Value(photonMomentum) );
+
+  if ( reflected && geometry.mirrorReflectivity )
+    mOneShotSurvival *= geometry.mirrorReflectivity->Value(photonMomentum);
+
+  mOneShotPos = toLocal.InverseTransformPoint(finalPos);
+  mOneShotDir = toLocal.InverseTransformAxis(finalDir);
+  mOneShotTime = track->GetGlobalTime() + pathLength/track->CalculateVelocityForOpticalPhoton();
+  mTransportLength = axialTravel;
+  mSavedReflections = nChord;
+
+  return true;
+}
+
+void FastSimModelOpFiber::oneShotDoIt(const G4Track* track, G4FastStep& faststep) {
+  if ( G4UniformRand() > mOneShotSurvival ) { // absorbed on the way
+    faststep.ProposeTotalEnergyDeposited(track->GetKineticEnergy());
+    faststep.KillPrimaryTrack();
+    mCounters.killed++;
+
+    return;
+  }
+
+  mCounters.transported++;
+  mCounters.savedReflections += mSavedReflections;
+  mCounters.fillLength(mTransportLength);
+
+  // keep the polarization perpendicular to the new direction
+  G4ThreeVector polarization = track->GetPolarization() - mOneShotDir*mOneShotDir.dot( track->GetPolarization() );
+  polarization = ( polarization.mag2() > 0. ) ? polarization.unit() : mOneShotDir.orthogonal().unit();
+
+  // path length is not proposed, otherwise the absorption is counted twice by G4OpAbsorption
+  faststep.ProposePrimaryTrackFinalPosition( mOneShotPos, false );
+  faststep.ProposePrimaryTrackFinalTime( mOneShotTime );
+  faststep.ProposePrimaryTrackFinalKineticEnergy( track->GetKineticEnergy() );
+  faststep.ProposePrimaryTrackFinalMomentumDirection( mOneShotDir, false );
+  faststep.ProposePrimaryTrackFinalPolarization( polarization, false );
+
+  return;
+}
+
+void FastSimModelOpFiber::setLengthHist(G4int nBins, G4double lengthMax) {
+  mCounters.lengthHist.assign( std::max(nBins,0), 0 );
+  mCounters.lengthMax = lengthMax;
+}
+
+void FastFiberCounters::fillLength(G4double length) {
+  if ( lengthHist.empty() )
+    return;
+
+  // overflow in the last bin
+  size_t bin = static_cast<size_t>( std::max( length/lengthMax*static_cast<G4double>(lengthHist.size()), 0. ) );
+  lengthHist.at( std::min( bin, lengthHist.size()-1 ) )++;
+}
+
+FastFiberCounters& FastFiberCounters::operator+=(const FastFiberCounters& other) {
+  calls += other.calls;
+  triggered += other.triggered;
+  transported += other.transported;
+  killed += other.killed;
+  batched += other.batched;
+  nillResets += other.nillResets;
+  savedReflections += other.savedReflections;
+
+  for (size_t idx = 0; idx < rejected.size(); idx++)
+    rejected.at(idx) += other.rejected.at(idx);
+
+  if ( lengthHist.size()==other.lengthHist.size() ) {
+    for (size_t idx = 0; idx < lengthHist.size(); idx++)
+      lengthHist.at(idx) += other.lengthHist.at(idx);
+  }
+
+  return *this;
+}
+
+void FastSimModelOpFiber::setBatch(G4bool batch, const G4String& sdName) {
+  mBatch = batch ? std::make_unique<FiberBatchTransport>() : nullptr;
+  fSDName = sdName;
+}
+
+void FastSimModelOpFiber::batchDoIt(const G4Track* track, G4FastStep& faststep) {
+  auto theTouchable = track->GetTouchableHandle();
+  const FastFiberGeometry& geometry = fiberGeometry( theTouchable() );
+
+  const G4AffineTransform& toLocal = theTouchable->GetHistory()->GetTopTransform();
+  G4ThreeVector pos = toLocal.TransformPoint( track->GetPosition() );
+  G4ThreeVector dir = toLocal.TransformAxis( track->GetMomentumDirection() );
+
+  const G4double photonMomentum = track->GetDynamicParticle()->GetTotalMomentum();
+  const G4double invAbsLength = geometry.absLength ? 1./geometry.absLength->Value(photonMomentum) : 0.;
+  const G4double reflectivity = geometry.mirrorReflectivity ? geometry.mirrorReflectivity->Value(photonMomentum) : 1.;
+  const G4int weight = static_cast<G4int>( std::lround( track->GetWeight() ) ); // weighted optical photons
+
+  auto* sd = sensitiveDetector();
+
+  mBatch->add( sd->fiberCellID( theTouchable() ), geometry.tubs->GetZHalfLength(), geometry.hasMirror, pos.z(), dir.z(), track->GetGlobalTime(),
+               invAbsLength, 1./track->CalculateVelocityForOpticalPhoton(), reflectivity, track->GetTotalEnergy(), weight );
+
+  // delivered to the SiPM at the end of the event
+  faststep.KillPrimaryTrack();
+  mCounters.batched++;
+
   return;
 }
 
+void FastSimModelOpFiber::flushBatch() {
+  if ( !mBatch || mBatch->size()==0 )
+    return;
+
+  // the stream of the event is keyed by the seed, the run & event IDs and a draw of the engine of the event,
+  // each fiber draws from its own stream so that the threads of the batch transport need no ordering
+  const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+  const G4Event* event = G4EventManager::GetEventManager()->GetConstCurrentEvent();
+
+  std::uint64_t eventKey = drc::DRcaloRandom::key( fSeed, static_cast<std::uint64_t>( run ? run->GetRunID() : 0 ) );
+  eventKey = drc::DRcaloRandom::key( eventKey, static_cast<std::uint64_t>( event ? event->GetEventID() : 0 ) );
+  eventKey = drc::DRcaloRandom::key( eventKey, static_cast<std::uint64_t>( G4UniformRand()*9007199254740992. ) );
+
+  mBatch->transport(
+    [eventKey](std::uint64_t cID, size_t n, double* buffer) { drc::DRcaloRandom(eventKey,cID).flatArray(n,buffer); },
+    [this](std::uint64_t cID, const FiberBatchTransport::Arrival& arrival) {
+      pSD->addPhotons( cID, arrival.size(), arrival.time.data(), arrival.energy.data(), arrival.weight.data() );
+    }
+  );
+}
+
+drc::DRcaloSiPMSD* FastSimModelOpFiber::sensitiveDetector() {
+  if (pSD)
+    return pSD;
+
+  // SDs are thread-local, look up the one of this thread
+  pSD = dynamic_cast<drc::DRcaloSiPMSD*>( G4SDManager::GetSDMpointer()->FindSensitiveDetector(fSDName,false) );
+
+  if (!pSD)
+    throw std::runtime_error("FastSimModelOpFiber: unable to find DRcaloSiPMSD " + fSDName);
+
+  pSD->addEndOfEventHook( [this]() { flushBatch(); } );
+
+  return pSD;
+}
+
+const FastFiberGeometry& FastSimModelOpFiber::fiberGeometry(const G4VTouchable* touchable) {
+  const G4LogicalVolume* lv = touchable->GetVolume()->GetLogicalVolume();
+  auto found = mFiberGeometries.find(lv);
+
+  if ( found!=mFiberGeometries.end() )
+    return found->second;
+
+  FastFiberGeometry geometry;
+  geometry.tubs = dynamic_cast<const G4Tubs*>( lv->GetSolid() );
+  geometry.isCore = ( lv->GetName().rfind("core",0)==0 );
+
+  auto* mpt = lv->GetMaterial()->GetMaterialPropertiesTable();
+
+  if (mpt) {
+    geometry.absLength = mpt->GetProperty(kABSLENGTH);
+    geometry.wlsAbsLength = mpt->GetProperty(kWLSABSLENGTH);
+  }
+
+  // fiberEnv > clad > core, the mirror is a sibling of the cladding
+  if ( geometry.isCore && touchable->GetHistoryDepth() >= 2 ) {
+    const G4LogicalVolume* envLV = touchable->GetVolume(2)->GetLogicalVolume();
+
+    for (size_t idx = 0; idx < envLV->GetNoDaughters(); idx++) {
+      auto* skin = G4LogicalSkinSurface::GetSurface( envLV->GetDaughter(idx)->GetLogicalVolume() );
+      auto* surf = skin ? dynamic_cast<G4OpticalSurface*>( skin->GetSurfaceProperty() ) : nullptr;
+
+      if ( !surf || surf->GetType()!=dielectric_metal )
+        continue;
+
+      geometry.hasMirror = true;
+
+      if ( surf->GetMaterialPropertiesTable() )
+        geometry.mirrorReflectivity = surf->GetMaterialPropertiesTable()->GetProperty(kREFLECTIVITY);
+    }
+  }
+
+  return mFiberGeometries.emplace(lv,geometry).first->second;
+}
+
 G4bool FastSimModelOpFiber::checkTotalInternalReflection(const G4Track* track) {
   if (!fProcAssigned)
     setPostStepProc(track); // locate OpBoundaryProcess only once
@@ -368,6 +731,7 @@ void FastSimModelOpFiber::print() {
 }
 
 void FastSimModelOpFiber::DefineCommands() {
+  // created by every thread owning a model, commands issued on the master are broadcast to the workers
   mMessenger = new G4GenericMessenger(this, "/fastfiber/model/", "fastfiber model control");
   G4GenericMessenger::Command& safetyCmd = mMessenger->DeclareProperty("safety",fSafety,"min number of total internal reflection");
   safetyCmd.SetParameterName("safety",true);
@@ -377,6 +741,10 @@ void FastSimModelOpFiber::DefineCommands() {
   switchCmd.SetParameterName("on",true);
   switchCmd.SetDefaultValue("True");
 
+  G4GenericMessenger::Command& oneShotCmd = mMessenger->DeclareProperty("oneshot",fOneShot,"transport trapped photons to the fiber end at the first total internal reflection");
+  oneShotCmd.SetParameterName("oneshot",true);
+  oneShotCmd.SetDefaultValue("False");
+
   G4GenericMessenger::Command& verboseCmd = mMessenger->DeclareProperty("verbose",fVerbose,"verbose level");
   verboseCmd.SetParameterName("verbose",true);
   verboseCmd.SetDefaultValue("0");
@@ -0,0 +1,147 @@
+#include "FastSimModelShowerLibrary.h"
+
+#include "G4ParticleDefinition.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4Gamma.hh"
+#include "G4SDManager.hh"
+#include "G4TransportationManager.hh"
+#include "G4NavigationHistory.hh"
+#include "G4Trap.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+  // depth of the SiPM points inside the back face of the tower
+  const G4double kBackDepth = 1.*mm;
+  // no azimuthal rotation below this angle to the tower axis
+  const G4double kMinTheta = 1.*mrad;
+}
+
+FastSimModelShowerLibrary::FastSimModelShowerLibrary(G4String name, G4Region* envelope, const drc::DRcaloShowerLibrary* library, const G4String& sdName)
+: G4VFastSimulationModel(name,envelope), pLibrary(library), pSD(nullptr), fSDName(sdName), fThreshold(1.*GeV), mShowers(0), mMissing(0) {}
+
+FastSimModelShowerLibrary::~FastSimModelShowerLibrary() {}
+
+G4bool FastSimModelShowerLibrary::IsApplicable(const G4ParticleDefinition& type) {
+  return &type == G4Electron::ElectronDefinition() || &type == G4Positron::PositronDefinition() || &type == G4Gamma::GammaDefinition();
+}
+
+G4bool FastSimModelShowerLibrary::ModelTrigger(const G4FastTrack& fasttrack) {
+  // the first step in the tower of a particle above the threshold is its entry (or its birth)
+  return fasttrack.GetPrimaryTrack()->GetKineticEnergy() > fThreshold;
+}
+
+void FastSimModelShowerLibrary::DoIt(const G4FastTrack& fasttrack, G4FastStep& faststep) {
+  const G4Track* track = fasttrack.GetPrimaryTrack();
+  const G4double energy = track->GetKineticEnergy();
+
+  faststep.ProposeTotalEnergyDeposited(energy);
+  faststep.KillPrimaryTrack();
+
+  // the envelope is the tower, its frame is the frame of the library
+  auto* sd = sensitiveDetector();
+  const auto* seg = sd->segmentation();
+  const G4int numEta = seg->numEta( seg->convertFirst32to64( fasttrack.GetEnvelopePhysicalVolume()->GetCopyNo() ) );
+  const G4ThreeVector pos = fasttrack.GetPrimaryTrackLocalPosition();
+  const G4ThreeVector dir = fasttrack.GetPrimaryTrackLocalDirection();
+
+  const auto* shower = pLibrary->find( numEta >= 0 ? numEta : -numEta-1, energy/GeV, dir.theta(), G4UniformRand() );
+
+  if (!shower) {
+    mMissing++;
+    return;
+  }
+
+  mShowers++;
+
+  const G4double rotation = ( dir.theta() > kMinTheta && shower->theta > kMinTheta ) ? dir.phi() - shower->phi : 0.;
+  const G4double cosRot = std::cos(rotation);
+  const G4double sinRot = std::sin(rotation);
+  const G4double scale = energy/( static_cast<G4double>(shower->energy)*GeV );
+
+  auto* trap = dynamic_cast<const G4Trap*>( fasttrack.GetEnvelopeSolid() );
+  const G4double backZ = ( trap ? trap->GetZHalfLength() : 0. ) - kBackDepth;
+  const G4AffineTransform* toGlobal = fasttrack.GetInverseAffineTransformation();
+  G4bool relative = false;
+
+  for (const auto& sipm : shower->sipms) {
+    G4ThreeVector local( pos.x() + ( cosRot*sipm.dx - sinRot*sipm.dy )*mm, pos.y() + ( sinRot*sipm.dx + cosRot*sipm.dy )*mm, backZ );
+    G4ThreeVector global = toGlobal->TransformPoint(local);
+    const G4NavigationHistory* history = locateTower(global,relative);
+    relative = true;
+
+    if (!history)
+      continue; // outside the calorimeter
+
+    // time & wavelength spectra are paired bin by bin in order, the SD keeps only the spectra
+    mTimes.clear();
+    mEnergies.clear();
+    mWeights.clear();
+
+    auto wavBin = sipm.wavlen.begin();
+    int wavLeft = ( wavBin!=sipm.wavlen.end() ) ? wavBin->second : 0;
+
+    for (const auto& timeBin : sipm.time) {
+      for (int iPhoton = 0; iPhoton < timeBin.second; iPhoton++) {
+        while ( wavLeft==0 && wavBin!=sipm.wavlen.end() && ++wavBin!=sipm.wavlen.end() )
+          wavLeft = wavBin->second;
+
+        G4double wavlen = ( wavBin!=sipm.wavlen.end() ) ? wavBin->first : 450.;
+        wavLeft--;
+
+        // stochastic rounding of the scaled count
+        G4int weight = static_cast<G4int>( std::floor(scale) );
+
+        if ( G4UniformRand() < scale - std::floor(scale) )
+          weight++;
+
+        if ( weight==0 )
+          continue;
+
+        mTimes.push_back( track->GetGlobalTime() + timeBin.first*ns );
+        mEnergies.push_back( h_Planck*c_light/(wavlen*nm) );
+        mWeights.push_back(weight);
+      }
+    }
+
+    if ( !mTimes.empty() )
+      sd->addPhotons( sd->sipmCellID(history,global), mTimes.size(), mTimes.data(), mEnergies.data(), mWeights.data() );
+  }
+}
+
+const G4NavigationHistory* FastSimModelShowerLibrary::locateTower(const G4ThreeVector& global, G4bool relative) {
+  if (!fNavigator) {
+    fNavigator = std::make_unique<G4Navigator>();
+    fNavigator->SetWorldVolume( G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume() );
+    relative = false;
+  }
+
+  fNavigator->LocateGlobalPointAndUpdateTouchable(global,&fTouchable,relative);
+
+  // world > assembly > tower
+  const G4int towerLevel = 2;
+  const G4NavigationHistory* history = fTouchable.GetHistory();
+
+  if ( history->GetDepth() < towerLevel || history->GetVolume(towerLevel)->GetLogicalVolume()->GetName().rfind("tower",0)!=0 )
+    return nullptr;
+
+  return history;
+}
+
+drc::DRcaloSiPMSD* FastSimModelShowerLibrary::sensitiveDetector() {
+  if (pSD)
+    return pSD;
+
+  // SDs are thread-local, look up the one of this thread
+  pSD = dynamic_cast<drc::DRcaloSiPMSD*>( G4SDManager::GetSDMpointer()->FindSensitiveDetector(fSDName,false) );
+
+  if (!pSD)
+    throw std::runtime_error("FastSimModelShowerLibrary: unable to find DRcaloSiPMSD " + fSDName);
+
+  return pSD;
+}
@@ -0,0 +1,38 @@
+#include "FastSimOpFiberWorkerInitialization.h"
+
+FastSimOpFiberWorkerInitialization::FastSimOpFiberWorkerInitialization(std::function<void()> build, const G4UserWorkerInitialization* chained)
+: G4UserWorkerInitialization(), fBuild(build), pChained(chained) {}
+
+FastSimOpFiberWorkerInitialization::~FastSimOpFiberWorkerInitialization() {
+  delete pChained;
+}
+
+void FastSimOpFiberWorkerInitialization::WorkerInitialize() const {
+  if (pChained)
+    pChained->WorkerInitialize();
+}
+
+void FastSimOpFiberWorkerInitialization::WorkerStart() const {
+  fBuild();
+
+  if (pChained)
+    pChained->WorkerStart();
+}
+
+void FastSimOpFiberWorkerInitialization::WorkerStartRun() const {
+  // workers may have been started before the region is created (e.g. by G4MTRunManager::Initialize)
+  fBuild();
+
+  if (pChained)
+    pChained->WorkerStartRun();
+}
+
+void FastSimOpFiberWorkerInitialization::WorkerRunEnd() const {
+  if (pChained)
+    pChained->WorkerRunEnd();
+}
+
+void FastSimOpFiberWorkerInitialization::WorkerStop() const {
+  if (pChained)
+    pChained->WorkerStop();
+}
@@ -0,0 +1,132 @@
+#include "FiberBatchTransport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+  // exp(x) of a finite x <= 0 without branches or calls, so that the kernel vectorizes without -ffast-math,
+  // relative error below 1e-12 down to -708 (clamped below, where the survival is 0 anyway)
+  inline double expNegative(double x) {
+    const double shift = 0x1.8p52; // rounds to the nearest integer in the low bits of the mantissa
+    const double log2e = 1.4426950408889634;
+    const double ln2hi = 6.93147180369123816490e-01;
+    const double ln2lo = 1.90821492927058770002e-10;
+
+    // max(x,-708) without a comparison, which would not be if-converted under the default -ftrapping-math
+    x = 0.5*( x - 708. + std::abs(x + 708.) );
+    const double t = x*log2e + shift;
+    const double n = t - shift;
+    const double r = x - n*ln2hi - n*ln2lo; // |r| <= ln2/2
+
+    // Taylor series to the 11th order
+    double p = 1./39916800.;
+    p = p*r + 1./3628800.;
+    p = p*r + 1./362880.;
+    p = p*r + 1./40320.;
+    p = p*r + 1./5040.;
+    p = p*r + 1./720.;
+    p = p*r + 1./120.;
+    p = p*r + 1./24.;
+    p = p*r + 1./6.;
+    p = p*r + 0.5;
+    p = p*r + 1.;
+    p = p*r + 1.;
+
+    // 2^n from the exponent bits
+    std::uint64_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    bits = 0x3ff0000000000000ULL + ( bits << 52 );
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+
+    return p*scale;
+  }
+}
+
+void FiberBatchTransport::add(std::uint64_t key, double halfZ, bool hasMirror, double z, double dirZ, double time,
+                              double invAbsLength, double invVelocity, double mirrorReflectivity, double energy, int weight) {
+  auto found = fIndex.find(key);
+
+  if ( found==fIndex.end() ) {
+    found = fIndex.emplace(key,fBatches.size()).first;
+    fBatches.emplace_back();
+    fBatches.back().key = key;
+    fBatches.back().halfZ = halfZ;
+    fBatches.back().hasMirror = hasMirror;
+  }
+
+  Batch& batch = fBatches.at(found->second);
+  batch.z.push_back(z);
+  batch.dirZ.push_back(dirZ);
+  batch.time.push_back(time);
+  batch.invAbsLength.push_back(invAbsLength);
+  batch.invVelocity.push_back(invVelocity);
+  batch.mirrorReflectivity.push_back(mirrorReflectivity);
+  batch.energy.push_back(energy);
+  batch.weight.push_back(weight);
+  fSize++;
+}
+
+void FiberBatchTransport::transport(const std::function<void(std::uint64_t, size_t, double*)>& flat,
+                                    const std::function<void(std::uint64_t, const Arrival&)>& deliver) {
+  for (const auto& batch : fBatches) {
+    fRand.resize(batch.size());
+    flat(batch.key, batch.size(), fRand.data());
+
+    transportBatch(batch, fRand.data(), fArrivalTime, fSurvival, fArrival);
+
+    if ( fArrival.size() > 0 )
+      deliver(batch.key, fArrival);
+  }
+
+  clear();
+}
+
+void FiberBatchTransport::transportBatch(const Batch& batch, const double* rand, std::vector<double>& arrivalTime,
+                                         std::vector<double>& survival, Arrival& arrival) {
+  const size_t n = batch.size();
+
+  arrivalTime.resize(n);
+  survival.resize(n);
+
+  propagate(n, batch.halfZ, batch.hasMirror, batch.z.data(), batch.dirZ.data(), batch.time.data(),
+            batch.invAbsLength.data(), batch.invVelocity.data(), batch.mirrorReflectivity.data(),
+            arrivalTime.data(), survival.data());
+
+  arrival.time.clear();
+  arrival.energy.clear();
+  arrival.weight.clear();
+
+  for (size_t idx = 0; idx < n; idx++) {
+    if ( rand[idx] >= survival[idx] )
+      continue;
+
+    arrival.time.push_back(arrivalTime[idx]);
+    arrival.energy.push_back(batch.energy[idx]);
+    arrival.weight.push_back(batch.weight[idx]);
+  }
+}
+
+void FiberBatchTransport::clear() {
+  fBatches.clear();
+  fIndex.clear();
+  fSize = 0;
+}
+
+void FiberBatchTransport::propagate(size_t n, double halfZ, bool hasMirror, const double* __restrict__ z, const double* __restrict__ dirZ,
+                                    const double* __restrict__ time, const double* __restrict__ invAbsLength, const double* __restrict__ invVelocity,
+                                    const double* __restrict__ mirrorReflectivity, double* __restrict__ arrival, double* __restrict__ survival) {
+  const double farEnd = hasMirror ? 1. : 0.;
+
+  // keep the loop free of branches and selects so that it vectorizes without blend instructions
+  for (size_t idx = 0; idx < n; idx++) {
+    const double forward = 0.5*( 1. + std::copysign(1.,dirZ[idx]) ); // 1 toward the SiPM, 0 otherwise
+    const double axial = forward*( halfZ - z[idx] ) + ( 1. - forward )*( 3.*halfZ + z[idx] ); // back and forth via the -z end
+    const double pathLength = axial/std::abs(dirZ[idx]);
+    const double reflectivity = forward + ( 1. - forward )*farEnd*mirrorReflectivity[idx];
+
+    arrival[idx] = time[idx] + pathLength*invVelocity[idx];
+    survival[idx] = expNegative( -pathLength*invAbsLength[idx] )*reflectivity;
+  }
+}
@@ -2,9 +2,14 @@
 
 // Geant4
 #include "G4RegionStore.hh"
+#include "G4RunManager.hh"
 #include "G4TransportationManager.hh"
 #include "G4VFastSimulationModel.hh"
 
+#include "FastSimOpFiberWorkerInitialization.h"
+
+#include <algorithm>
+
 DECLARE_COMPONENT(SimG4FastSimOpFiberRegion)
 
 SimG4FastSimOpFiberRegion::SimG4FastSimOpFiberRegion(const std::string& type, const std::string& name, const IInterface* parent)
@@ -18,18 +23,98 @@ StatusCode SimG4FastSimOpFiberRegion::initialize() {
   if (GaudiTool::initialize().isFailure())
     return StatusCode::FAILURE;
 
+  if (!m_fiberLUT.empty()) {
+    m_lut = std::make_unique<drc::DRcaloFiberLUT>();
+
+    if (!m_lut->read(m_fiberLUT)) {
+      error() << "Unable to read the fiber lookup table " << m_fiberLUT << " (version " << drc::DRcaloFiberLUT::kVersion << " expected)" << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    info() << "Fiber lookup table is read from " << m_fiberLUT << endmsg;
+  }
+
   return StatusCode::SUCCESS;
 }
 
-StatusCode SimG4FastSimOpFiberRegion::finalize() { return GaudiTool::finalize(); }
+StatusCode SimG4FastSimOpFiberRegion::finalize() {
+  printCounters();
+
+  return GaudiTool::finalize();
+}
+
+void SimG4FastSimOpFiberRegion::printCounters() {
+  G4AutoLock lock(&m_mutex);
+
+  FastFiberCounters sum;
+  sum.lengthHist.assign( std::max(m_lengthHistBins.value(),0), 0 );
+
+  for (const auto& models : m_models)
+    sum += models.second.model->counters();
+
+  if ( sum.calls==0 )
+    return;
+
+  const double calls = static_cast<double>(sum.calls);
+
+  info() << "FastSimModelOpFiber counters summed over " << m_models.size() << " thread(s)" << endmsg;
+  info() << "  ModelTrigger calls " << sum.calls << ", triggered " << sum.triggered << " (" << 100.*sum.triggered/calls << "%)" << endmsg;
+  info() << "  rejected: no repetitive TIR " << sum.rejected.at(FastFiberCounters::kNoTIR)
+         << ", not a G4Tubs core " << sum.rejected.at(FastFiberCounters::kNoTubs)
+         << ", too close to the end (safety) " << sum.rejected.at(FastFiberCounters::kSafety)
+         << ", WLS " << sum.rejected.at(FastFiberCounters::kWLS) << endmsg;
+  info() << "  transported " << sum.transported << ", killed by absorption " << sum.killed << ", batched " << sum.batched
+         << ", NILL resets " << sum.nillResets << endmsg;
+
+  if ( sum.transported > 0 )
+    info() << "  reflections saved per transport " << sum.savedReflections/static_cast<double>(sum.transported) << endmsg;
+
+  if ( sum.lengthHist.empty() )
+    return;
+
+  const double binWidth = m_lengthHistMax/static_cast<double>(sum.lengthHist.size());
+  info() << "  transported axial length [mm] (last bin includes overflow)" << endmsg;
+
+  for (size_t idx = 0; idx < sum.lengthHist.size(); idx++)
+    info() << "    [" << binWidth*idx << ", " << binWidth*(idx+1) << ") " << sum.lengthHist.at(idx) << endmsg;
+}
 
 StatusCode SimG4FastSimOpFiberRegion::create() {
-  auto* regionStore = G4RegionStore::GetInstance();
-  auto* region = regionStore->GetRegion( static_cast<std::string>(m_regionName) );
+  buildModels();
+
+  info() << "Creating " << ( m_lut ? "FastSimModelFiberLUT and " : "" ) << "FastSimModelOpFiber models with the region " << m_regionName << endmsg;
+
+  auto* runManager = G4RunManager::GetRunManager();
+
+  if ( runManager->GetRunManagerType()!=G4RunManager::masterRM )
+    return StatusCode::SUCCESS;
 
-  m_model = std::make_unique<FastSimModelOpFiber>("FastSimModelOpFiber",region);
+  // multithreaded, every worker builds its own models (the fast simulation manager of a region is thread-local)
+  // the run manager takes the ownership of the worker initialization
+  runManager->SetUserInitialization( new FastSimOpFiberWorkerInitialization( [this]() { buildModels(); }, runManager->GetUserWorkerInitialization() ) );
 
-  info() << "Creating FastSimModelOpFiber model with the region " << m_regionName << endmsg;
+  info() << "FastSimModelOpFiber models will be created for each worker thread" << endmsg;
 
   return StatusCode::SUCCESS;
 }
+
+void SimG4FastSimOpFiberRegion::buildModels() {
+  G4AutoLock lock(&m_mutex);
+  const G4int threadID = G4Threading::G4GetThreadId();
+
+  if ( m_models.find(threadID)!=m_models.end() )
+    return;
+
+  auto* region = G4RegionStore::GetInstance()->GetRegion( static_cast<std::string>(m_regionName) );
+  ThreadModels& models = m_models[threadID];
+
+  // models are tried in the order of creation, the lookup table takes the photons born in the cores first
+  if (m_lut)
+    models.lutModel = std::make_unique<FastSimModelFiberLUT>("FastSimModelFiberLUT",region,m_lut.get(),m_sdName);
+
+  models.model = std::make_unique<FastSimModelOpFiber>("FastSimModelOpFiber",region);
+  models.model->setOneShot(m_oneShot);
+  models.model->setBatch(m_batch,m_sdName);
+  models.model->setSeed(m_seed);
+  models.model->setLengthHist(m_lengthHistBins,m_lengthHistMax);
+}
@@ -0,0 +1,121 @@
+#include "SimG4FastSimShowerLibraryRegion.h"
+
+// Geant4
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include "FastSimOpFiberWorkerInitialization.h"
+
+DECLARE_COMPONENT(SimG4FastSimShowerLibraryRegion)
+
+SimG4FastSimShowerLibraryRegion::SimG4FastSimShowerLibraryRegion(const std::string& type, const std::string& name, const IInterface* parent)
+: GaudiTool(type, name, parent) {
+  declareInterface<ISimG4RegionTool>(this);
+}
+
+SimG4FastSimShowerLibraryRegion::~SimG4FastSimShowerLibraryRegion() {}
+
+StatusCode SimG4FastSimShowerLibraryRegion::initialize() {
+  if (GaudiTool::initialize().isFailure())
+    return StatusCode::FAILURE;
+
+  m_library = std::make_unique<drc::DRcaloShowerLibrary>();
+
+  if ( m_showerLibrary.empty() || !m_library->read(m_showerLibrary) ) {
+    error() << "Unable to read the shower library " << m_showerLibrary << " (version " << drc::DRcaloShowerLibrary::kVersion << " expected)" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  info() << m_library->size() << " showers are read from " << m_showerLibrary << endmsg;
+
+  return StatusCode::SUCCESS;
+}
+
+StatusCode SimG4FastSimShowerLibraryRegion::finalize() {
+  G4AutoLock lock(&m_mutex);
+
+  G4long showers = 0;
+  G4long missing = 0;
+
+  for (const auto& model : m_models) {
+    showers += model.second->showers();
+    missing += model.second->missing();
+  }
+
+  if ( showers + missing > 0 )
+    info() << "FastSimModelShowerLibrary replaced " << showers << " showers, " << missing << " particles without a library shower are killed" << endmsg;
+
+  return GaudiTool::finalize();
+}
+
+StatusCode SimG4FastSimShowerLibraryRegion::create() {
+  if (!towerRegion()) {
+    error() << "Unable to make the region " << m_regionName << " of the tower volumes" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  buildModel();
+
+  info() << "Creating FastSimModelShowerLibrary model with the region " << m_regionName << endmsg;
+
+  auto* runManager = G4RunManager::GetRunManager();
+
+  if ( runManager->GetRunManagerType()!=G4RunManager::masterRM )
+    return StatusCode::SUCCESS;
+
+  // multithreaded, every worker builds its own model (the fast simulation manager of a region is thread-local)
+  runManager->SetUserInitialization( new FastSimOpFiberWorkerInitialization( [this]() { buildModel(); }, runManager->GetUserWorkerInitialization() ) );
+
+  return StatusCode::SUCCESS;
+}
+
+G4Region* SimG4FastSimShowerLibraryRegion::towerRegion() {
+  auto* region = G4RegionStore::GetInstance()->GetRegion( static_cast<std::string>(m_regionName), false );
+
+  if (region)
+    return region;
+
+  // the daughters (but the fiber cores & claddings of the fiber region) belong to the region of the tower
+  std::vector<G4LogicalVolume*> towers;
+
+  for (auto* lv : *G4LogicalVolumeStore::GetInstance()) {
+    if ( lv->GetName().rfind("tower",0)==0 )
+      towers.push_back(lv);
+  }
+
+  if ( towers.empty() )
+    return nullptr;
+
+  // a volume cannot be the root of two regions
+  if ( towers.front()->IsRootRegion() ) {
+    error() << "Tower volumes already belong to the region " << towers.front()->GetRegion()->GetName()
+            << ", use it as regionName" << endmsg;
+    return nullptr;
+  }
+
+  region = new G4Region( static_cast<std::string>(m_regionName) ); // owned by G4RegionStore
+  region->SetProductionCuts( G4RegionStore::GetInstance()->GetRegion("DefaultRegionForTheWorld")->GetProductionCuts() );
+
+  for (auto* lv : towers)
+    region->AddRootLogicalVolume(lv);
+
+  info() << "Region " << m_regionName << " is created with " << towers.size() << " tower volume(s)" << endmsg;
+
+  return region;
+}
+
+void SimG4FastSimShowerLibraryRegion::buildModel() {
+  G4AutoLock lock(&m_mutex);
+  const G4int threadID = G4Threading::G4GetThreadId();
+
+  if ( m_models.find(threadID)!=m_models.end() )
+    return;
+
+  auto* region = G4RegionStore::GetInstance()->GetRegion( static_cast<std::string>(m_regionName) );
+  auto& model = m_models[threadID];
+  model = std::make_unique<FastSimModelShowerLibrary>("FastSimModelShowerLibrary",region,m_library.get(),m_sdName);
+  model->setEnergyThreshold(m_threshold*CLHEP::MeV/Gaudi::Units::MeV);
+}
@@ -4,6 +4,11 @@
 #include "G4VUserActionInitialization.hh"
 
 #include "GridDRcalo.h"
+#include "DRcaloFiberLUT.h"
+#include "DRcaloShowerLibrary.h"
+
+#include <cstdint>
+#include <map>
 
 namespace drc {
 class SimG4DRcaloActionInitialization : public G4VUserActionInitialization {
@@ -12,16 +17,57 @@ public:
   virtual ~SimG4DRcaloActionInitialization();
 
   virtual void Build() const final;
+  virtual void BuildForMaster() const final;
 
   void setSegmentation(dd4hep::DDSegmentation::GridDRcalo* seg) { pSeg = seg; }
   void setThreshold(const double thres) { m_thres = thres; }
+  void setVoxelSize(const double slice, const double transverse) { m_voxelSlice = slice; m_voxelXY = transverse; }
+  void setApplyFilter(const bool apply) { m_applyFilter = apply; }
+  void setApplyPDE(const bool apply) { m_applyPDE = apply; }
+  void setPhotonWeight(const int weight) { m_photonWeight = weight; }
+  void setMaxStackedPhotons(const int num) { m_maxStackedPhotons = num; }
+  void setMaxDeferredPhotons(const long num) { m_maxDeferredPhotons = num; }
+  void setSeed(const std::uint64_t seed) { m_seed = seed; }
+  void setKillPolicy(const double timeCut, const double neutronTimeCut, const std::map<int,double>& energyCuts);
+  void setFiberAcceptance(const bool apply) { m_fiberAcceptance = apply; }
+  void setFiberEdeps(const bool apply) { m_fiberEdeps = apply; }
+  void setFiberLUT(DRcaloFiberLUT* lut) { m_fiberLUT = lut; }
+  void setShowerLibrary(DRcaloShowerLibrary* library) { m_showerLibrary = library; }
+  void setPhotonFree(const bool apply, const std::string sdName, const double scintEff, const double cerenEff, const double signalSpeed);
   void setBirksConstant(const std::string scintName, const double birks);
+  void setBenchmarkOutput(const std::string& filename) { m_benchmarkOutput = filename; }
+  void setProfileSteps(const bool apply) { m_profileSteps = apply; }
 
 private:
+  // materials are shared by the threads, set only once by the master (or the sequential run manager)
+  void applyBirksConstant() const;
+
   dd4hep::DDSegmentation::GridDRcalo* pSeg;
   std::string m_scintName;
   double m_birks;
   double m_thres;
+  double m_voxelSlice;
+  double m_voxelXY;
+  bool m_applyFilter;
+  bool m_applyPDE;
+  int m_photonWeight;
+  int m_maxStackedPhotons;
+  long m_maxDeferredPhotons;
+  std::uint64_t m_seed;
+  double m_killTime;
+  double m_neutronKillTime;
+  std::map<int,double> m_killEnergies;
+  bool m_fiberAcceptance;
+  bool m_fiberEdeps;
+  DRcaloFiberLUT* m_fiberLUT;
+  DRcaloShowerLibrary* m_showerLibrary;
+  bool m_photonFree;
+  std::string m_sdName;
+  double m_scintEff;
+  double m_cerenEff;
+  double m_signalSpeed;
+  std::string m_benchmarkOutput;
+  bool m_profileSteps;
 };
 }
 
@@ -0,0 +1,66 @@
+#ifndef SimG4DRcaloBenchmark_h
+#define SimG4DRcaloBenchmark_h 1
+
+#include "G4Track.hh"
+#include "G4Event.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4OpticalPhoton.hh"
+
+#include "DRcaloArena.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace drc {
+// Throughput counters of a run, summed over the threads at the end of the run
+struct SimG4DRcaloBenchmarkCounters {
+  long photonsCreated = 0; // optical photons pushed to the stack, killed at birth included
+  long photonsTracked = 0; // optical photons taking at least a step
+  long photonsDetected = 0; // photons counted by the SiPMs, weights included
+  std::unordered_map<const G4ParticleDefinition*, long> steps; // the definitions are shared by the threads
+  DRcaloArenaStats hitArena; // allocations of the SiPM hit payloads
+
+  SimG4DRcaloBenchmarkCounters& operator+=(const SimG4DRcaloBenchmarkCounters& other);
+};
+
+// Fills the benchmark counters of the current run of the thread, called by the stacking, stepping & event actions
+class SimG4DRcaloBenchmark {
+public:
+  SimG4DRcaloBenchmark() : pCounters(nullptr) {}
+  ~SimG4DRcaloBenchmark() {}
+
+  // the SiPM hit arenas of the thread report to the counters as they allocate & free
+  void setCounters(SimG4DRcaloBenchmarkCounters* counters) {
+    pCounters = counters;
+    DRcaloArena::setStats( counters ? &counters->hitArena : nullptr );
+  }
+
+  void countNewTrack(const G4Track* track) {
+    if ( pCounters && track->GetDefinition()==G4OpticalPhoton::OpticalPhotonDefinition() )
+      pCounters->photonsCreated++;
+  }
+
+  void countStep(const G4Track* track) {
+    if (!pCounters)
+      return;
+
+    pCounters->steps[ track->GetDefinition() ]++;
+
+    if ( track->GetCurrentStepNumber()==1 && track->GetDefinition()==G4OpticalPhoton::OpticalPhotonDefinition() )
+      pCounters->photonsTracked++;
+  }
+
+  // sums the photon counts of the SiPM hits of the event
+  void countDetected(const G4Event* event);
+
+  // writes the summary of a run as a JSON object, times in s & peak resident set size of the process in MB
+  static bool writeJson(const std::string& filename, const SimG4DRcaloBenchmarkCounters& counters,
+                        long events, double wallTime, double cpuTime);
+  static double peakRSS();
+
+private:
+  SimG4DRcaloBenchmarkCounters* pCounters;
+};
+}
+
+#endif
@@ -5,11 +5,14 @@
 #include "G4Event.hh"
 
 #include "SimG4DRcaloSteppingAction.h"
+#include "SimG4DRcaloShowerRecorder.h"
+#include "SimG4DRcaloBenchmark.h"
+#include "SimG4DRcaloProfiler.h"
 
-#include "edm4hep/MCParticleCollection.h"
-#include "edm4hep/SimCalorimeterHitCollection.h"
+#include <memory>
 
 namespace drc {
+// attaches a SimG4DRcaloEventInformation holding the MC truth collections to every event of the thread
 class SimG4DRcaloEventAction : public G4UserEventAction {
 public:
   SimG4DRcaloEventAction();
@@ -19,18 +22,16 @@ public:
   virtual void EndOfEventAction(const G4Event*) final;
 
   void setSteppingAction(SimG4DRcaloSteppingAction* steppingAction) { pSteppingAction = steppingAction; }
-
-  edm4hep::SimCalorimeterHitCollection* getEdepsCollection() { return m_Edeps; }
-  edm4hep::SimCalorimeterHitCollection* getEdeps3dCollection() { return m_Edeps3d; }
-  edm4hep::MCParticleCollection* getLeakagesCollection() { return m_Leakages; }
+  void setBenchmark(SimG4DRcaloBenchmark* benchmark) { pBenchmark = benchmark; }
+  void setProfiler(SimG4DRcaloProfiler* profiler) { pProfiler = profiler; }
+  // takes the ownership
+  void setShowerRecorder(SimG4DRcaloShowerRecorder* recorder) { fShowerRecorder.reset(recorder); }
 
 private:
   SimG4DRcaloSteppingAction* pSteppingAction;
-
-  // ownership of collections transferred to DataWrapper<T>
-  edm4hep::SimCalorimeterHitCollection* m_Edeps;
-  edm4hep::SimCalorimeterHitCollection* m_Edeps3d;
-  edm4hep::MCParticleCollection* m_Leakages;
+  SimG4DRcaloBenchmark* pBenchmark; // owned by SimG4DRcaloRunAction
+  SimG4DRcaloProfiler* pProfiler; // owned by SimG4DRcaloRunAction
+  std::unique_ptr<SimG4DRcaloShowerRecorder> fShowerRecorder;
 };
 }
 
@@ -0,0 +1,39 @@
+#ifndef SimG4DRcaloEventInformation_h
+#define SimG4DRcaloEventInformation_h 1
+
+#include "G4VUserEventInformation.hh"
+
+#include "edm4hep/MCParticleCollection.h"
+#include "edm4hep/SimCalorimeterHitCollection.h"
+
+#include <memory>
+
+namespace drc {
+// MC truth collections of a G4Event, filled by the actions of the thread processing the event
+// the save tool takes the ownership of the collections, otherwise they are deleted together with the event
+class SimG4DRcaloEventInformation : public G4VUserEventInformation {
+public:
+  SimG4DRcaloEventInformation();
+  virtual ~SimG4DRcaloEventInformation() {}
+
+  virtual void Print() const;
+
+  edm4hep::SimCalorimeterHitCollection* edeps() { return m_Edeps.get(); }
+  edm4hep::SimCalorimeterHitCollection* edeps3d() { return m_Edeps3d.get(); }
+  edm4hep::MCParticleCollection* leakages() { return m_Leakages.get(); }
+  edm4hep::SimCalorimeterHitCollection* fiberEdeps() { return m_FiberEdeps.get(); }
+
+  edm4hep::SimCalorimeterHitCollection* releaseEdeps() { return m_Edeps.release(); }
+  edm4hep::SimCalorimeterHitCollection* releaseEdeps3d() { return m_Edeps3d.release(); }
+  edm4hep::MCParticleCollection* releaseLeakages() { return m_Leakages.release(); }
+  edm4hep::SimCalorimeterHitCollection* releaseFiberEdeps() { return m_FiberEdeps.release(); }
+
+private:
+  std::unique_ptr<edm4hep::SimCalorimeterHitCollection> m_Edeps;
+  std::unique_ptr<edm4hep::SimCalorimeterHitCollection> m_Edeps3d;
+  std::unique_ptr<edm4hep::MCParticleCollection> m_Leakages;
+  std::unique_ptr<edm4hep::SimCalorimeterHitCollection> m_FiberEdeps;
+};
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef SimG4DRcaloFiberAcceptance_h
+#define SimG4DRcaloFiberAcceptance_h 1
+
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4LogicalVolume.hh"
+#include "G4MaterialPropertyVector.hh"
+
+#include <unordered_map>
+
+namespace drc {
+// Tells whether an optical photon can be trapped in the fiber it is born
+// the ray in a cylindrical fiber keeps beta = n*d_z and l = n*(r x d)_z,
+// it is totally reflected at the radius R toward the medium n' if beta^2 + l^2/R^2 > n'^2
+class SimG4DRcaloFiberAcceptance {
+public:
+  SimG4DRcaloFiberAcceptance() {}
+  ~SimG4DRcaloFiberAcceptance() {}
+
+  // true unless the photon escapes the fiber (or hits the dark end of the scintillation fiber)
+  bool isTrapped(const G4Track* track);
+
+  // true if the photon left the fiber through its side (air hole or fiber envelope)
+  bool isEscaping(const G4Step* step);
+
+private:
+  struct FiberInfo {
+    bool isFiber = false;
+    bool inCore = false; // born in the core (otherwise in the cladding)
+    bool isScint = false;
+    double rCore = 0.;
+    double rClad = 0.;
+    G4MaterialPropertyVector* rindexBirth = nullptr;
+    G4MaterialPropertyVector* rindexClad = nullptr;
+    G4MaterialPropertyVector* rindexOut = nullptr;
+  };
+
+  enum class EnvType { kNone, kFiberEnv, kAirHole };
+
+  const FiberInfo& fiberInfo(const G4VTouchable* touchable);
+  EnvType envType(const G4LogicalVolume* lv);
+
+  std::unordered_map<const G4LogicalVolume*, FiberInfo> fFiberInfos;
+  std::unordered_map<const G4LogicalVolume*, EnvType> fEnvTypes;
+};
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SimG4DRcaloFiberEdepArena_h
+#define SimG4DRcaloFiberEdepArena_h 1
+
+#include "DDSegmentation/Segmentation.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace drc {
+// Energy deposit per fiber of an event
+// a tower touched for the first time takes a block of numX x numY slots (dense SiPM index x*numY + y) from a pool,
+// the pool keeps its capacity over the events and the reset only zeroes the occupied slots
+class SimG4DRcaloFiberEdepArena {
+public:
+  struct Fiber {
+    dd4hep::DDSegmentation::CellID cellID; // SiPM attached to the fiber
+    float edep;
+  };
+
+  SimG4DRcaloFiberEdepArena() : fUsed(0) {}
+  ~SimG4DRcaloFiberEdepArena() {}
+
+  void add(dd4hep::DDSegmentation::CellID tower, int numX, int numY, int x, int y, dd4hep::DDSegmentation::CellID sipm, float edep);
+  void reset();
+
+  size_t size() const { return fOccupied.size(); }
+  Fiber fiber(size_t idx) const { return { fCellIDs[ fOccupied[idx] ], fPool[ fOccupied[idx] ] }; }
+
+private:
+  std::unordered_map<dd4hep::DDSegmentation::CellID, size_t> fBlocks; // offset of the block of a tower
+  std::vector<float> fPool;
+  std::vector<dd4hep::DDSegmentation::CellID> fCellIDs;
+  std::vector<size_t> fOccupied; // slots in the order of the first deposit
+  size_t fUsed;
+};
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef SimG4DRcaloFiberLUTRecorder_h
+#define SimG4DRcaloFiberLUTRecorder_h 1
+
+#include "G4UserTrackingAction.hh"
+#include "G4Track.hh"
+
+#include "DRcaloFiberLUT.h"
+
+namespace drc {
+// Fills the fiber response lookup table with the fully simulated optical photons born in the fiber cores
+// the table belongs to the run of the thread (set by SimG4DRcaloRunAction), the runs of the workers are merged at the end of the run
+class SimG4DRcaloFiberLUTRecorder : public G4UserTrackingAction {
+public:
+  SimG4DRcaloFiberLUTRecorder();
+  virtual ~SimG4DRcaloFiberLUTRecorder();
+
+  void setTable(DRcaloFiberLUT* lut) { pLUT = lut; }
+
+  virtual void PreUserTrackingAction(const G4Track* track);
+  virtual void PostUserTrackingAction(const G4Track* track);
+
+private:
+  DRcaloFiberLUT* pLUT; // owned by SimG4DRcaloRun
+
+  // birth of the current track
+  bool fBornInCore;
+  bool fIsCerenkov;
+  double fDist;
+  double fCosTheta;
+  double fWavlen;
+};
+}
+
+#endif
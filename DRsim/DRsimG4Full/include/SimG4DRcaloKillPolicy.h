@@ -0,0 +1,73 @@
+#ifndef SimG4DRcaloKillPolicy_h
+#define SimG4DRcaloKillPolicy_h 1
+
+#include "G4Track.hh"
+
+#include <array>
+#include <map>
+#include <ostream>
+
+namespace drc {
+// Tracks killed by SimG4DRcaloKillPolicy by the PDG code, summed over the threads at the end of the run
+struct SimG4DRcaloKillCounters {
+  enum Reason { kTime = 0, kNeutronTime, kEnergy, kNumReasons };
+
+  struct Count {
+    long tracks = 0;
+    double energy = 0.; // kinetic energy not tracked
+  };
+
+  std::map<int, std::array<Count, kNumReasons>> byPDG;
+
+  void count(Reason reason, int pdg, double ekin);
+  bool empty() const { return byPDG.empty(); }
+  void clear() { byPDG.clear(); }
+  SimG4DRcaloKillCounters& operator+=(const SimG4DRcaloKillCounters& other);
+  void print(std::ostream& out) const;
+};
+
+// Kills the tracks that cannot contribute to the signal within the readout window
+// - every track (optical photons included) later than the global time cut, e.g. the end of the integration gate
+// - neutrons later than their own time cut
+// - secondaries born below the kinetic energy threshold of their PDG code
+class SimG4DRcaloKillPolicy {
+public:
+  SimG4DRcaloKillPolicy();
+  ~SimG4DRcaloKillPolicy() {}
+
+  // 0 to switch off
+  void setTimeCut(double cut) { fTimeCut = cut; }
+  void setNeutronTimeCut(double cut) { fNeutronTimeCut = cut; }
+  void setEnergyCut(int pdg, double cut) { fEnergyCuts[pdg] = cut; }
+
+  bool isActive() const { return fTimeCut > 0. || fNeutronTimeCut > 0. || !fEnergyCuts.empty(); }
+
+  // counters of the current run of the thread
+  void setCounters(SimG4DRcaloKillCounters* counters) { pCounters = counters; }
+
+  // called by the stacking action for new tracks
+  bool killAtBirth(const G4Track* track);
+  // called by the stepping action at every step
+  bool killInFlight(const G4Track* track) {
+    const double time = track->GetGlobalTime();
+
+    // cheap check first, most steps are early
+    if ( ( fTimeCut <= 0. || time <= fTimeCut ) && ( fNeutronTimeCut <= 0. || time <= fNeutronTimeCut ) )
+      return false;
+
+    return killLate(track);
+  }
+
+private:
+  bool killLate(const G4Track* track);
+  void count(SimG4DRcaloKillCounters::Reason reason, const G4Track* track);
+
+  double fTimeCut;
+  double fNeutronTimeCut;
+  std::map<int, double> fEnergyCuts; // by PDG code
+
+  SimG4DRcaloKillCounters* pCounters;
+};
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef SimG4DRcaloPhotonFree_h
+#define SimG4DRcaloPhotonFree_h 1
+
+#include "G4Step.hh"
+#include "G4LogicalVolume.hh"
+#include "G4MaterialPropertyVector.hh"
+
+#include "DRcaloSiPMSD.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace drc {
+// Converts a charged step in a fiber core into photoelectrons without optical photons
+// scintillation: Birks-corrected energy deposit x light yield x efficiency
+// Cherenkov: Frank-Tamm yield x efficiency (trapping fraction x PDE)
+// the photoelectrons are Poisson distributed and delivered to the SiPM hit of the fiber
+class SimG4DRcaloPhotonFree {
+public:
+  SimG4DRcaloPhotonFree();
+  ~SimG4DRcaloPhotonFree() {}
+
+  void setSDName(const std::string& name) { fSDName = name; }
+  void setScintEff(double eff) { fScintEff = eff; }
+  void setCerenEff(double eff) { fCerenEff = eff; }
+  void setSignalSpeed(double speed) { fSignalSpeed = speed; }
+
+  void convert(const G4Step* step);
+
+private:
+  struct CoreInfo {
+    bool isCore = false;
+    bool isCerenkov = false;
+    double halfZ = 0.;
+    double scintYield = 0.; // photons per energy
+    double scintTime = 0.;
+    G4MaterialPropertyVector* rindex = nullptr;
+    G4MaterialPropertyVector* scintSpectrum = nullptr;
+  };
+
+  const CoreInfo& coreInfo(const G4LogicalVolume* lv);
+  DRcaloSiPMSD* sensitiveDetector();
+
+  // number of Cherenkov photons per unit length of a unit charge
+  double frankTamm(const CoreInfo& info, double beta) const;
+  double sampleCerenkovEnergy(const CoreInfo& info, double beta) const;
+  double sampleScintEnergy(const CoreInfo& info) const;
+
+  std::string fSDName;
+  DRcaloSiPMSD* pSD;
+
+  double fScintEff;
+  double fCerenEff;
+  double fSignalSpeed;
+
+  std::unordered_map<const G4LogicalVolume*, CoreInfo> fCoreInfos;
+
+  // photoelectrons of a step delivered at once to the SiPM hit, reused over the steps
+  std::vector<G4double> fTimes;
+  std::vector<G4double> fEnergies;
+  std::vector<G4int> fWeights;
+};
+}
+
+#endif
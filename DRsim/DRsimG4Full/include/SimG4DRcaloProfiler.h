@@ -0,0 +1,67 @@
+#ifndef SimG4DRcaloProfiler_h
+#define SimG4DRcaloProfiler_h 1
+
+#include "G4Step.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VProcess.hh"
+
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace drc {
+// Steps & wall time by volume type, particle type & process, summed over the threads at the end of the run
+struct SimG4DRcaloProfileCounters {
+  struct Entry {
+    long steps = 0;
+    double time = 0.; // s
+  };
+
+  // by name, the volumes & processes are thread-local
+  std::map<std::string, Entry> byVolume;
+  std::map<std::string, Entry> byParticle;
+  std::map<std::string, Entry> byProcess;
+
+  bool empty() const { return byParticle.empty(); }
+  SimG4DRcaloProfileCounters& operator+=(const SimG4DRcaloProfileCounters& other);
+  // ranked by the time
+  void print(std::ostream& out) const;
+};
+
+// Profiles the steps of a thread, called by the stepping action at every step
+// the wall time since the previous step (or the beginning of the event) is attributed to the step,
+// to the logical volume of its pre-step point, to the type of the particle and to the process that limited it
+class SimG4DRcaloProfiler {
+public:
+  SimG4DRcaloProfiler();
+  ~SimG4DRcaloProfiler() {}
+
+  // counters of the current run of the thread
+  void setCounters(SimG4DRcaloProfileCounters* counters);
+
+  void beginEvent() { fLast = std::chrono::steady_clock::now(); }
+  void profile(const G4Step* step);
+
+private:
+  typedef SimG4DRcaloProfileCounters::Entry Entry;
+  enum ParticleType { kOptical = 0, kCharged, kNeutral, kNumParticleTypes };
+
+  Entry* volumeEntry(const G4LogicalVolume* lv);
+  Entry* processEntry(const G4VProcess* process);
+
+  // e.g. coreC, tower or sipmLayer, whatever the suffix given by the geometry
+  static std::string volumeType(const std::string& name);
+
+  SimG4DRcaloProfileCounters* pCounters;
+  std::chrono::steady_clock::time_point fLast;
+
+  // entries of the current run
+  std::unordered_map<const G4LogicalVolume*, Entry*> fVolumes;
+  std::unordered_map<const G4VProcess*, Entry*> fProcesses;
+  Entry* fParticles[kNumParticleTypes];
+};
+}
+
+#endif
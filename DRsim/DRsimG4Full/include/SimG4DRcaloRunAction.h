@@ -0,0 +1,67 @@
+#ifndef SimG4DRcaloRunAction_h
+#define SimG4DRcaloRunAction_h 1
+
+#include "G4UserRunAction.hh"
+#include "G4Run.hh"
+#include "G4Timer.hh"
+
+#include "SimG4DRcaloKillPolicy.h"
+#include "SimG4DRcaloBenchmark.h"
+#include "SimG4DRcaloProfiler.h"
+#include "SimG4DRcaloFiberLUTRecorder.h"
+#include "DRcaloFiberLUT.h"
+
+#include <memory>
+#include <string>
+
+namespace drc {
+// run holding the counters of the kill policy, of the benchmark & of the profiler and the fiber lookup table being recorded,
+// the runs of the workers are merged into the one of the master
+class SimG4DRcaloRun : public G4Run {
+public:
+  SimG4DRcaloRun() : G4Run() {}
+  virtual ~SimG4DRcaloRun() {}
+
+  virtual void Merge(const G4Run* run);
+
+  SimG4DRcaloKillCounters& killCounters() { return fKillCounters; }
+  SimG4DRcaloBenchmarkCounters& benchmarkCounters() { return fBenchmarkCounters; }
+  SimG4DRcaloProfileCounters& profileCounters() { return fProfileCounters; }
+  void setFiberLUT(std::unique_ptr<DRcaloFiberLUT> lut) { fFiberLUT = std::move(lut); }
+  DRcaloFiberLUT* fiberLUT() { return fFiberLUT.get(); }
+
+private:
+  SimG4DRcaloKillCounters fKillCounters;
+  SimG4DRcaloBenchmarkCounters fBenchmarkCounters;
+  SimG4DRcaloProfileCounters fProfileCounters;
+  std::unique_ptr<DRcaloFiberLUT> fFiberLUT; // nullptr if the table is not recorded
+};
+
+// prints what the kill policy has killed, the profile of the steps and the CPU time per event at the end of the run
+// (master or sequential only), writes the benchmark counters to a JSON file and adds the recorded fiber lookup table to the shared one if requested
+class SimG4DRcaloRunAction : public G4UserRunAction {
+public:
+  SimG4DRcaloRunAction(SimG4DRcaloKillPolicy* policy, SimG4DRcaloBenchmark* benchmark = nullptr, SimG4DRcaloProfiler* profiler = nullptr);
+  virtual ~SimG4DRcaloRunAction() {}
+
+  virtual G4Run* GenerateRun();
+  virtual void BeginOfRunAction(const G4Run* run);
+  virtual void EndOfRunAction(const G4Run* run);
+
+  void setBenchmarkOutput(const std::string& filename) { fBenchmarkOutput = filename; }
+  // table owned by SimG4DRcaloActions, filled by the master (or the sequential run manager) at the end of the run
+  void setFiberLUT(DRcaloFiberLUT* lut) { pFiberLUT = lut; }
+  void setFiberLUTRecorder(SimG4DRcaloFiberLUTRecorder* recorder) { pFiberLUTRecorder = recorder; }
+
+private:
+  std::unique_ptr<SimG4DRcaloKillPolicy> fPolicy; // nullptr for the master
+  std::unique_ptr<SimG4DRcaloBenchmark> fBenchmark; // nullptr for the master or if the benchmark is off
+  std::unique_ptr<SimG4DRcaloProfiler> fProfiler; // nullptr for the master or if the profiler is off
+  DRcaloFiberLUT* pFiberLUT;
+  SimG4DRcaloFiberLUTRecorder* pFiberLUTRecorder; // owned by G4
+  std::string fBenchmarkOutput;
+  G4Timer fTimer;
+};
+}
+
+#endif
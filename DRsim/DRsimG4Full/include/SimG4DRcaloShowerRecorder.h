@@ -0,0 +1,41 @@
+#ifndef SimG4DRcaloShowerRecorder_h
+#define SimG4DRcaloShowerRecorder_h 1
+
+#include "G4Step.hh"
+#include "G4Event.hh"
+#include "G4AffineTransform.hh"
+#include "G4ThreeVector.hh"
+
+#include "GridDRcalo.h"
+#include "DRcaloShowerLibrary.h"
+
+namespace drc {
+// Fills the shower library with the fully simulated showers of single-particle events
+// the entry of the primary into a tower fixes the frame, the SiPM hits of the event are converted at the end of the event
+// the library is shared by the threads and owned by SimG4DRcaloActions
+class SimG4DRcaloShowerRecorder {
+public:
+  SimG4DRcaloShowerRecorder(DRcaloShowerLibrary* library, dd4hep::DDSegmentation::GridDRcalo* seg);
+  ~SimG4DRcaloShowerRecorder() {}
+
+  void beginEvent() { fHasEntry = false; }
+  // called at every step, keeps the first step of the primary in a tower
+  void recordEntry(const G4Step* step);
+  void endEvent(const G4Event* event);
+
+private:
+  DRcaloShowerLibrary* pLibrary;
+  dd4hep::DDSegmentation::GridDRcalo* pSeg;
+
+  // entry of the primary
+  bool fHasEntry;
+  int fTowerNum32;
+  G4AffineTransform fToTower; // global to the frame of the entry tower
+  G4ThreeVector fLocalPos;
+  G4ThreeVector fLocalDir;
+  double fTime;
+  double fEnergy;
+};
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef SimG4DRcaloStackingAction_h
+#define SimG4DRcaloStackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "G4Track.hh"
+#include "G4MaterialPropertyVector.hh"
+#include "G4ThreeVector.hh"
+#include "G4TouchableHandle.hh"
+#include "G4VProcess.hh"
+
+#include "SimG4DRcaloFiberAcceptance.h"
+#include "SimG4DRcaloKillPolicy.h"
+#include "SimG4DRcaloBenchmark.h"
+#include "DRcaloRandom.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace drc {
+class SimG4DRcaloStackingAction : public G4UserStackingAction {
+public:
+  SimG4DRcaloStackingAction();
+  virtual ~SimG4DRcaloStackingAction();
+
+  virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track);
+  virtual void NewStage();
+  virtual void PrepareNewEvent();
+
+  // push a batch of deferred photons back if the urgent stack fell below half of its bound, called at every step
+  void releaseDeferred();
+
+  void setApplyFilter(const bool apply) { fApplyFilter = apply; }
+  void setApplyPDE(const bool apply) { fApplyPDE = apply; }
+  void setPhotonWeight(const int weight) { fPhotonWeight = weight; }
+  void setFiberAcceptance(const bool apply) { fFiberAcceptance = apply; }
+  // bound the number of tracks in the urgent stack, optical photons beyond it are deferred (0 to switch off)
+  void setMaxStackedPhotons(const int num) { fMaxStacked = num; }
+  // bound the deferred photons of an event, photons beyond it are killed with a warning (0 for no bound, the default)
+  void setMaxDeferredPhotons(const long num) { fMaxDeferred = num; }
+  void setKillPolicy(SimG4DRcaloKillPolicy* policy) { pKillPolicy = policy; }
+  void setBenchmark(SimG4DRcaloBenchmark* benchmark) { pBenchmark = benchmark; }
+  // seed of the counter-based stream of the photons killed at birth
+  void setSeed(const std::uint64_t seed) { fSeed = seed; }
+
+private:
+  // survival probability of the optical photon (filter transmittance x SiPM PDE)
+  double survivalProb(const G4Track* track) const;
+
+  // urgent, or deferred if the urgent stack is full
+  G4ClassificationOfNewTrack classifyAlive(const G4Track* track);
+
+  // optical photon waiting for the tracking without a G4Track, the classification is done before it is deferred
+  struct DeferredPhoton {
+    G4TouchableHandle touchable; // volume of birth, shared with its parent
+    G4ThreeVector position;
+    double time;
+    float direction[3];
+    float polarization[3];
+    float energy;
+    float weight;
+    int trackID;
+    int parentID;
+    const G4VProcess* creator;
+  };
+
+  void defer(const G4Track* track);
+  G4Track* release(const DeferredPhoton& photon) const;
+  // the last photon goes to the waiting stack if lastWaiting & any photon is left
+  void releaseBatch(size_t num, bool lastWaiting);
+
+  // geometry is not constructed at Build(), look up the surfaces at the first photon instead
+  static void cacheProperties(bool replacePDE);
+
+  bool fApplyFilter;
+  bool fApplyPDE;
+  int fPhotonWeight;
+  bool fFiberAcceptance;
+
+  SimG4DRcaloFiberAcceptance fAcceptance;
+
+  std::uint64_t fSeed;
+  DRcaloRandom fRandom; // stream of the current event
+
+  int fMaxStacked;
+  long fMaxDeferred;
+  long fDropped; // photons of the event killed beyond fMaxDeferred
+  std::vector<DeferredPhoton> fDeferred;
+  bool fHasSentinel; // a deferred photon is kept as a G4Track in the waiting stack so that NewStage() is called
+  bool fReleasing;
+  G4ClassificationOfNewTrack fReleaseClass;
+
+  SimG4DRcaloKillPolicy* pKillPolicy; // owned by SimG4DRcaloRunAction
+  SimG4DRcaloBenchmark* pBenchmark; // owned by SimG4DRcaloRunAction
+
+  // copy of the property vectors shared by the threads
+  static std::unique_ptr<G4MaterialPropertyVector> sTransmittance;
+  static std::unique_ptr<G4MaterialPropertyVector> sEfficiency;
+  static std::atomic<bool> sCached;
+};
+}
+
+#endif
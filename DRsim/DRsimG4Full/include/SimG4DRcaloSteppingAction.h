@@ -2,16 +2,29 @@
 #define SimG4DRcaloSteppingAction_h 1
 
 #include "GridDRcalo.h"
+#include "SimG4DRcaloFiberAcceptance.h"
+#include "SimG4DRcaloPhotonFree.h"
+#include "SimG4DRcaloFiberEdepArena.h"
+#include "SimG4DRcaloShowerRecorder.h"
+#include "SimG4DRcaloKillPolicy.h"
+#include "SimG4DRcaloBenchmark.h"
+#include "SimG4DRcaloProfiler.h"
+#include "SimG4DRcaloStackingAction.h"
 
 #include "G4UserSteppingAction.hh"
 #include "G4Track.hh"
 #include "G4StepPoint.hh"
-#include "G4OpticalSurface.hh"
+#include "G4ThreeVector.hh"
+#include "G4LogicalVolume.hh"
 
 // Data model
 #include "edm4hep/MCParticleCollection.h"
 #include "edm4hep/SimCalorimeterHitCollection.h"
 
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace drc {
 class SimG4DRcaloSteppingAction : public G4UserSteppingAction {
 public:
@@ -21,29 +34,78 @@ public:
   virtual void UserSteppingAction(const G4Step*);
 
   void setSegmentation(dd4hep::DDSegmentation::GridDRcalo* seg) { pSeg = seg; }
-  void setEdepsCollection(edm4hep::SimCalorimeterHitCollection* data) { m_Edeps = data; }
+  void setEdepsCollection(edm4hep::SimCalorimeterHitCollection* data);
   void setEdeps3dCollection(edm4hep::SimCalorimeterHitCollection* data) { m_Edeps3d = data; }
   void setLeakagesCollection(edm4hep::MCParticleCollection* data) { m_Leakages = data; }
+  void setFiberEdepsCollection(edm4hep::SimCalorimeterHitCollection* data);
 
   void setThreshold(const double thres) { m_thres = thres; }
+  // voxelize the 3d energy deposits by the longitudinal slice (and the transverse grid) in the tower frame, 0 to switch off
+  void setVoxelSize(const double slice, const double transverse) { fVoxelSlice = slice; fVoxelXY = transverse; }
+  void setFiberAcceptance(const bool apply) { fFiberAcceptance = apply; }
+  void setPhotonFree(const bool apply) { fPhotonFree = apply; }
+  void setFiberEdeps(const bool apply) { fFiberEdeps = apply; }
+  void setShowerRecorder(SimG4DRcaloShowerRecorder* recorder) { pShowerRecorder = recorder; }
+  void setKillPolicy(SimG4DRcaloKillPolicy* policy) { pKillPolicy = policy; }
+  void setBenchmark(SimG4DRcaloBenchmark* benchmark) { pBenchmark = benchmark; }
+  void setProfiler(SimG4DRcaloProfiler* profiler) { pProfiler = profiler; }
+  // releases the deferred optical photons while the shower is running
+  void setStackingAction(SimG4DRcaloStackingAction* stacking) { pStackingAction = stacking; }
+  // weight of the optical photons surviving the roulette of SimG4DRcaloStackingAction, given at their creation
+  void setPhotonWeight(const int weight) { fPhotonWeight = weight; }
+  SimG4DRcaloPhotonFree& photonFree() { return fPhotonFreeConv; }
+
+  // fill the tower sums of the event into the edeps collection, called at the end of the event
+  void flushEdeps();
 
 private:
-  void accumulate(unsigned int &prev, dd4hep::DDSegmentation::CellID& id64, float edep);
-  bool checkId(edm4hep::SimCalorimeterHit edep, dd4hep::DDSegmentation::CellID& id64);
+  void accumulate(dd4hep::DDSegmentation::CellID id64, float edep);
+  void accumulateVoxel(const G4VTouchable* touchable, int towerNum32, const G4ThreeVector& pos, float edep);
+  double towerHalfZ(int towerNum32);
+  void accumulateFiber(const G4VTouchable* touchable, dd4hep::DDSegmentation::CellID towerNum64, float edep);
 
   void saveLeakage(G4Track* track, G4StepPoint* pre);
+  void weightSecondaries(const G4Step* step);
+
+  // energy sum per tower in the order of the first deposit, indexed by the tower ID
+  std::vector<std::pair<dd4hep::DDSegmentation::CellID, float>> fTowerEdeps;
+  std::unordered_map<dd4hep::DDSegmentation::CellID, size_t> fTowerIndex;
+  size_t fPrevTower;
+
+  struct Voxel {
+    dd4hep::DDSegmentation::CellID tower = 0;
+    double edep = 0.;
+    G4ThreeVector weightedPos; // sum of edep x position
+  };
+
+  double fVoxelSlice;
+  double fVoxelXY;
+  std::vector<Voxel> fVoxels;
+  std::unordered_map<unsigned long long, size_t> fVoxelIndex; // (tower, slice, x, y) packed
+  std::unordered_map<int, double> fTowerHalfZ; // by numEta
 
-  unsigned int fPrevTower;
-  unsigned int fPrevFiber;
-  int fPrevId;
+  bool fFiberEdeps;
+  SimG4DRcaloFiberEdepArena fFiberArena;
+  std::unordered_map<const G4LogicalVolume*, bool> fIsCore;
+  std::unordered_map<int, std::pair<int,int>> fTowerGrid; // numX & numY by numEta
 
-  G4OpticalSurface* fFilterSurf;
+  bool fFiberAcceptance;
+  SimG4DRcaloFiberAcceptance fAcceptance;
+  bool fPhotonFree;
+  int fPhotonWeight;
+  SimG4DRcaloPhotonFree fPhotonFreeConv;
+  SimG4DRcaloShowerRecorder* pShowerRecorder; // owned by SimG4DRcaloEventAction
+  SimG4DRcaloKillPolicy* pKillPolicy; // owned by SimG4DRcaloRunAction
+  SimG4DRcaloBenchmark* pBenchmark; // owned by SimG4DRcaloRunAction
+  SimG4DRcaloProfiler* pProfiler; // owned by SimG4DRcaloRunAction
+  SimG4DRcaloStackingAction* pStackingAction; // owned by G4
   dd4hep::DDSegmentation::GridDRcalo* pSeg;
 
   // collections owned by SimG4DRcaloEventAction
   edm4hep::SimCalorimeterHitCollection* m_Edeps;
   edm4hep::SimCalorimeterHitCollection* m_Edeps3d;
   edm4hep::MCParticleCollection* m_Leakages;
+  edm4hep::SimCalorimeterHitCollection* m_FiberEdeps;
   double m_thres;
 };
 }
@@ -1,5 +1,9 @@
 #include "SimG4DRcaloActions.h"
 
+#include "DRcaloSiPMSD.h"
+
+#include "DD4hep/Detector.h"
+
 DECLARE_COMPONENT(SimG4DRcaloActions)
 
 SimG4DRcaloActions::SimG4DRcaloActions(const std::string& type, const std::string& name, const IInterface* parent)
@@ -19,18 +23,101 @@ StatusCode SimG4DRcaloActions::initialize() {
     return StatusCode::FAILURE;
   }
 
+  if (m_photonWeight < 1) {
+    error() << "Weight of the optical photons should be a positive integer!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  if ( m_maxStackedPhotons < 0 || m_maxDeferredPhotons < 0 ) {
+    error() << "Maximum numbers of stacked & deferred optical photons should not be negative!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  if ( m_killTime < 0. || m_neutronKillTime < 0. ) {
+    error() << "Time cuts of the kill policy should not be negative!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  if ( m_voxelSlice < 0. || m_voxelXY < 0. ) {
+    error() << "Voxel sizes of the 3d SimCalorimeterHits should not be negative!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  // checked by SimG4SaveDRcaloHits, the photon records are meant to be replayed with the filter & PDE
+  drc::DRcaloSiPMSD::setFilteredAtBirth( !m_photonFree && ( m_applyFilter || m_applyPDE ) );
+
+  if (!m_fiberLUTOutput.empty())
+    m_fiberLUT = std::make_unique<drc::DRcaloFiberLUT>();
+
+  if (!m_showerLibraryOutput.empty())
+    m_showerLibrary = std::make_unique<drc::DRcaloShowerLibrary>();
+
   pSeg = dynamic_cast<dd4hep::DDSegmentation::GridDRcalo*>(m_geoSvc->lcdd()->readout(m_readoutName).segmentation().segmentation());
 
+  if (m_photonFree) {
+    for (auto& sdEntry : m_geoSvc->lcdd()->sensitiveDetectors()) {
+      if ( dd4hep::SensitiveDetector(sdEntry.second).readout().name()==m_readoutName )
+        m_sdName = sdEntry.first;
+    }
+
+    if (m_sdName.empty()) {
+      error() << "Unable to find the sensitive detector of the readout " << m_readoutName << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    if ( m_signalSpeed <= 0. ) {
+      error() << "Signal speed of the photon-free mode should be positive!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    info() << "Photon-free mode is on, make sure that the optical physics is switched off" << endmsg;
+  }
+
   return StatusCode::SUCCESS;
 }
 
-StatusCode SimG4DRcaloActions::finalize() { return AlgTool::finalize(); }
+StatusCode SimG4DRcaloActions::finalize() {
+  if (m_fiberLUT) {
+    if (!m_fiberLUT->write(m_fiberLUTOutput)) {
+      error() << "Unable to write the fiber lookup table to " << m_fiberLUTOutput << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    info() << "Fiber lookup table is written to " << m_fiberLUTOutput << endmsg;
+  }
+
+  if (m_showerLibrary) {
+    if (!m_showerLibrary->write(m_showerLibraryOutput)) {
+      error() << "Unable to write the shower library to " << m_showerLibraryOutput << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    info() << m_showerLibrary->size() << " showers are written to " << m_showerLibraryOutput << endmsg;
+  }
+
+  return AlgTool::finalize();
+}
 
 G4VUserActionInitialization* SimG4DRcaloActions::userActionInitialization() {
   auto* actions = new drc::SimG4DRcaloActionInitialization();
   actions->setSegmentation(pSeg);
   actions->setBirksConstant(m_scintName,m_birks);
   actions->setThreshold(m_thres);
+  actions->setVoxelSize(m_voxelSlice,m_voxelXY);
+  actions->setApplyFilter(m_applyFilter);
+  actions->setApplyPDE(m_applyPDE);
+  actions->setPhotonWeight(m_photonWeight);
+  actions->setMaxStackedPhotons(m_maxStackedPhotons);
+  actions->setMaxDeferredPhotons(m_maxDeferredPhotons);
+  actions->setSeed(m_seed);
+  actions->setKillPolicy(m_killTime,m_neutronKillTime,m_killEnergies);
+  actions->setFiberAcceptance(m_fiberAcceptance);
+  actions->setFiberEdeps(m_fiberEdeps);
+  actions->setFiberLUT(m_fiberLUT.get());
+  actions->setShowerLibrary(m_showerLibrary.get());
+  actions->setPhotonFree(m_photonFree,m_sdName,m_scintEff,m_cerenEff,m_signalSpeed);
+  actions->setBenchmarkOutput(m_benchmarkOutput);
+  actions->setProfileSteps(m_profileSteps);
 
   return actions;
 }
@@ -14,6 +14,11 @@
 #include "SimG4DRcaloActionInitialization.h"
 
 #include "GridDRcalo.h"
+#include "DRcaloFiberLUT.h"
+#include "DRcaloShowerLibrary.h"
+
+#include <map>
+#include <memory>
 
 class SimG4DRcaloActions : public AlgTool, virtual public ISimG4ActionTool {
 public:
@@ -28,11 +33,35 @@ public:
 private:
   ServiceHandle<IGeoSvc> m_geoSvc;
   dd4hep::DDSegmentation::GridDRcalo* pSeg;
+  std::string m_sdName;
+  std::unique_ptr<drc::DRcaloFiberLUT> m_fiberLUT;
+  std::unique_ptr<drc::DRcaloShowerLibrary> m_showerLibrary;
 
   Gaudi::Property<std::string> m_readoutName{this, "readoutName", "DRcaloSiPMreadout", "readout name of DRcalo"};
   Gaudi::Property<std::string> m_scintName{this, "scintName", "DR_Polystyrene", "Name of the scintillators"};
   Gaudi::Property<double> m_birks{this, "birks", 0.126, "Birk's constant for the scintillators in mm/MeV"};
   Gaudi::Property<double> m_thres{this, "thres", 0.0001, "Energy threshold to store 3d SimCalorimeterHits in GeV"};
+  Gaudi::Property<double> m_voxelSlice{this, "voxelSlice", 0., "Voxelize 3d SimCalorimeterHits by longitudinal slices of the tower in mm (0 to store a hit per step)"};
+  Gaudi::Property<double> m_voxelXY{this, "voxelXY", 0., "Transverse grid of the voxels in the tower frame in mm (0 for the whole tower cross section)"};
+  Gaudi::Property<bool> m_fiberEdeps{this, "fiberEdeps", false, "Store the energy deposit per fiber core (cell ID of the SiPM) as SimFiberCalorimeterHits"};
+  Gaudi::Property<bool> m_applyFilter{this, "applyFilter", true, "Apply the filter transmittance to the scintillation photons at birth"};
+  Gaudi::Property<bool> m_applyPDE{this, "applyPDE", true, "Apply the SiPM PDE to the optical photons at birth instead of the SiPM surface"};
+  Gaudi::Property<bool> m_fiberAcceptance{this, "fiberAcceptance", false, "Kill optical photons outside the trapping cone of the fibers at birth"};
+  Gaudi::Property<std::string> m_fiberLUTOutput{this, "fiberLUTOutput", "", "Record the fiber response lookup table to this file (empty to switch off)"};
+  Gaudi::Property<std::string> m_showerLibraryOutput{this, "showerLibraryOutput", "", "Record the shower of the primary of every event to this shower library file (empty to switch off)"};
+  Gaudi::Property<bool> m_photonFree{this, "photonFree", false, "Convert charged steps in the fiber cores to photoelectrons without optical photons (switch off the optical physics)"};
+  Gaudi::Property<double> m_scintEff{this, "scintEff", 6.e-4, "Photon-free mode: fraction of the scintillation photons detected (light collection x filter x PDE)"};
+  Gaudi::Property<double> m_cerenEff{this, "cerenEff", 0.015, "Photon-free mode: fraction of the Cherenkov photons detected (trapping fraction x PDE)"};
+  Gaudi::Property<double> m_signalSpeed{this, "signalSpeed", 190., "Photon-free mode: signal propagation speed along the fiber in mm/ns"};
+  Gaudi::Property<int> m_photonWeight{this, "photonWeight", 1, "Keep 1 out of w optical photons with weight w (1 to switch off)"};
+  Gaudi::Property<unsigned long> m_seed{this, "seed", 0, "Seed of the random stream of the photons killed at birth (PDE, fiber acceptance, weight), mixed with the run & event IDs"};
+  Gaudi::Property<int> m_maxStackedPhotons{this, "maxStackedPhotons", 0, "Defer the optical photons into a compact buffer while the urgent stack holds this many tracks, pushed back whenever it falls below half of it (0 to switch off)"};
+  Gaudi::Property<long> m_maxDeferredPhotons{this, "maxDeferredPhotons", 0, "Bound of the deferred optical photons of an event, photons beyond it are killed with a warning and lost to the signal (0 for no bound)"};
+  Gaudi::Property<double> m_killTime{this, "killTime", 0., "Kill every track (optical photons included) later than this global time in ns, e.g. gateStart + gateLength of DigiSiPM (0 to switch off)"};
+  Gaudi::Property<double> m_neutronKillTime{this, "neutronKillTime", 0., "Kill the neutrons later than this global time in ns (0 to switch off)"};
+  Gaudi::Property<std::map<int,double>> m_killEnergies{this, "killEnergies", {}, "Kill the secondaries born below the kinetic energy in MeV by PDG code, e.g. {2112: 1.}"};
+  Gaudi::Property<bool> m_profileSteps{this, "profileSteps", false, "Print the steps & wall time by volume type, particle type & process ranked at the end of the run"};
+  Gaudi::Property<std::string> m_benchmarkOutput{this, "benchmarkOutput", "", "Write events/s, CPU per event, peak RSS, optical photon & step counters of the run to this JSON file (empty to switch off)"};
 };
 
 #endif
@@ -0,0 +1,97 @@
+#include "SimG4DRcaloRegionCuts.h"
+
+// Geant4
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4UserLimits.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cfloat>
+
+DECLARE_COMPONENT(SimG4DRcaloRegionCuts)
+
+SimG4DRcaloRegionCuts::SimG4DRcaloRegionCuts(const std::string& type, const std::string& name, const IInterface* parent)
+: AlgTool(type, name, parent) {
+  declareInterface<ISimG4RegionTool>(this);
+}
+
+SimG4DRcaloRegionCuts::~SimG4DRcaloRegionCuts() {}
+
+StatusCode SimG4DRcaloRegionCuts::initialize() {
+  if (AlgTool::initialize().isFailure())
+    return StatusCode::FAILURE;
+
+  for (const auto& cut : m_productionCuts.value()) {
+    if ( cut.first!="*" && cut.first!="gamma" && cut.first!="e-" && cut.first!="e+" && cut.first!="proton" ) {
+      error() << "Production cuts are only defined for gamma, e-, e+ and proton, not for " << cut.first << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    if ( cut.second < 0. ) {
+      error() << "Production cut of " << cut.first << " should not be negative!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+  }
+
+  if ( m_maxStep < 0. || m_maxTrackLength < 0. || m_maxTime < 0. || m_minEkine < 0. || m_minRange < 0. ) {
+    error() << "User limits should not be negative!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+StatusCode SimG4DRcaloRegionCuts::finalize() { return AlgTool::finalize(); }
+
+StatusCode SimG4DRcaloRegionCuts::create() {
+  auto* regionStore = G4RegionStore::GetInstance();
+  auto* region = regionStore->GetRegion( static_cast<std::string>(m_regionName), false );
+
+  if (!region) {
+    error() << "Unable to find the region " << m_regionName << ", it should be defined by the compact file" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  if (!m_productionCuts.value().empty()) {
+    // a region without its own cuts shares the ones of the world, start from a copy
+    const G4ProductionCuts* current = region->GetProductionCuts();
+
+    if (!current)
+      current = regionStore->GetRegion("DefaultRegionForTheWorld")->GetProductionCuts();
+
+    auto* cuts = new G4ProductionCuts(*current); // kept by the region until the end of the job
+
+    // the cut of every particle first, the particle-specific ones override it
+    auto all = m_productionCuts.value().find("*");
+
+    if ( all!=m_productionCuts.value().end() )
+      cuts->SetProductionCut(all->second*CLHEP::mm);
+
+    for (const auto& cut : m_productionCuts.value()) {
+      if ( cut.first!="*" )
+        cuts->SetProductionCut(cut.second*CLHEP::mm, cut.first);
+    }
+
+    region->SetProductionCuts(cuts);
+
+    info() << "Production cuts of the region " << m_regionName << ": gamma " << cuts->GetProductionCut("gamma")/CLHEP::mm
+           << " mm, e- " << cuts->GetProductionCut("e-")/CLHEP::mm << " mm, e+ " << cuts->GetProductionCut("e+")/CLHEP::mm
+           << " mm, proton " << cuts->GetProductionCut("proton")/CLHEP::mm << " mm" << endmsg;
+  }
+
+  if ( m_maxStep > 0. || m_maxTrackLength > 0. || m_maxTime > 0. || m_minEkine > 0. || m_minRange > 0. ) {
+    auto* limits = new G4UserLimits( m_maxStep > 0. ? m_maxStep*CLHEP::mm : DBL_MAX,
+                                     m_maxTrackLength > 0. ? m_maxTrackLength*CLHEP::mm : DBL_MAX,
+                                     m_maxTime > 0. ? m_maxTime*CLHEP::ns : DBL_MAX,
+                                     m_minEkine*CLHEP::MeV,
+                                     m_minRange*CLHEP::mm ); // kept by the region until the end of the job
+    region->SetUserLimits(limits);
+
+    info() << "User limits of the region " << m_regionName << ": max step " << m_maxStep << " mm, max track length " << m_maxTrackLength
+           << " mm, max time " << m_maxTime << " ns, min kinetic energy " << m_minEkine << " MeV, min range " << m_minRange
+           << " mm (0 is off), effective with the step limiter physics only" << endmsg;
+  }
+
+  return StatusCode::SUCCESS;
+}
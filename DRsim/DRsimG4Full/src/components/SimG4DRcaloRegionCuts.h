@@ -0,0 +1,33 @@
+#ifndef SimG4DRcaloRegionCuts_h
+#define SimG4DRcaloRegionCuts_h 1
+
+#include "GaudiKernel/AlgTool.h"
+#include "k4Interface/ISimG4RegionTool.h"
+
+#include <map>
+#include <string>
+
+// Sets the production cuts & G4UserLimits of a region defined by the compact file
+// (e.g. the absorber, fiber and SiPM regions of DRcalo), overriding the cut & limit set of the XML
+// G4UserLimits are effective only with the step limiter physics (SimG4UserLimitPhysicsList)
+class SimG4DRcaloRegionCuts : public AlgTool, virtual public ISimG4RegionTool {
+public:
+  explicit SimG4DRcaloRegionCuts(const std::string& type, const std::string& name, const IInterface* parent);
+  virtual ~SimG4DRcaloRegionCuts();
+
+  virtual StatusCode initialize() final;
+  virtual StatusCode finalize() final;
+
+  virtual StatusCode create() final;
+
+private:
+  Gaudi::Property<std::string> m_regionName{this, "regionName", "DRcaloAbsorberRegion", "Name of the region defined by the compact file"};
+  Gaudi::Property<std::map<std::string,double>> m_productionCuts{this, "productionCuts", {}, "Production cuts in mm by particle (gamma, e-, e+, proton or * for all), e.g. {'e-': 1.} (empty to keep the cuts of the region)"};
+  Gaudi::Property<double> m_maxStep{this, "maxStep", 0., "G4UserLimits: maximum step length in mm (0 to switch off)"};
+  Gaudi::Property<double> m_maxTrackLength{this, "maxTrackLength", 0., "G4UserLimits: maximum track length in mm (0 to switch off)"};
+  Gaudi::Property<double> m_maxTime{this, "maxTime", 0., "G4UserLimits: maximum global time in ns (0 to switch off)"};
+  Gaudi::Property<double> m_minEkine{this, "minEkine", 0., "G4UserLimits: minimum kinetic energy in MeV (0 to switch off)"};
+  Gaudi::Property<double> m_minRange{this, "minRange", 0., "G4UserLimits: minimum remaining range in mm (0 to switch off)"};
+};
+
+#endif
@@ -1,10 +1,16 @@
 #include "SimG4DRcaloActionInitialization.h"
 #include "SimG4DRcaloSteppingAction.h"
 #include "SimG4DRcaloEventAction.h"
+#include "SimG4DRcaloStackingAction.h"
+#include "SimG4DRcaloFiberLUTRecorder.h"
+#include "SimG4DRcaloShowerRecorder.h"
+#include "SimG4DRcaloRunAction.h"
 #include "CLHEP/Units/SystemOfUnits.h"
 
+#include "G4Threading.hh"
+
 namespace drc {
-SimG4DRcaloActionInitialization::SimG4DRcaloActionInitialization(): G4VUserActionInitialization() {}
+SimG4DRcaloActionInitialization::SimG4DRcaloActionInitialization(): G4VUserActionInitialization(), m_voxelSlice(0.), m_voxelXY(0.), m_applyFilter(true), m_applyPDE(true), m_photonWeight(1), m_maxStackedPhotons(0), m_maxDeferredPhotons(0), m_seed(0), m_killTime(0.), m_neutronKillTime(0.), m_fiberAcceptance(false), m_fiberEdeps(false), m_fiberLUT(nullptr), m_showerLibrary(nullptr), m_photonFree(false), m_profileSteps(false) {}
 
 SimG4DRcaloActionInitialization::~SimG4DRcaloActionInitialization() {}
 
@@ -13,16 +19,114 @@ void SimG4DRcaloActionInitialization::setBirksConstant(const std::string scintNa
   m_birks = birks;
 }
 
+void SimG4DRcaloActionInitialization::setPhotonFree(const bool apply, const std::string sdName, const double scintEff, const double cerenEff, const double signalSpeed) {
+  m_photonFree = apply;
+  m_sdName = sdName;
+  m_scintEff = scintEff;
+  m_cerenEff = cerenEff;
+  m_signalSpeed = signalSpeed;
+}
+
+void SimG4DRcaloActionInitialization::setKillPolicy(const double timeCut, const double neutronTimeCut, const std::map<int,double>& energyCuts) {
+  m_killTime = timeCut;
+  m_neutronKillTime = neutronTimeCut;
+  m_killEnergies = energyCuts;
+}
+
+void SimG4DRcaloActionInitialization::BuildForMaster() const {
+  // the master does not process events, the actions are built by Build() of each worker
+  applyBirksConstant();
+
+  auto* runAction = new SimG4DRcaloRunAction(nullptr); // deleted by G4
+  runAction->setBenchmarkOutput(m_benchmarkOutput);
+  runAction->setFiberLUT(m_fiberLUT);
+  SetUserAction(runAction);
+}
+
+void SimG4DRcaloActionInitialization::applyBirksConstant() const {
+  G4Material::GetMaterial(m_scintName)->GetIonisation()->SetBirksConstant(m_birks*CLHEP::millimeter/CLHEP::MeV); // makeshift for DD4hep
+}
+
 void SimG4DRcaloActionInitialization::Build() const {
+  auto* killPolicy = new SimG4DRcaloKillPolicy(); // deleted by the run action
+  killPolicy->setTimeCut(m_killTime*CLHEP::ns);
+  killPolicy->setNeutronTimeCut(m_neutronKillTime*CLHEP::ns);
+
+  for (const auto& cut : m_killEnergies)
+    killPolicy->setEnergyCut(cut.first, cut.second*CLHEP::MeV);
+
+  // the counters of the workers are written by the master
+  auto* benchmark = m_benchmarkOutput.empty() ? nullptr : new SimG4DRcaloBenchmark(); // deleted by the run action
+  auto* profiler = m_profileSteps ? new SimG4DRcaloProfiler() : nullptr; // deleted by the run action
+  auto* runAction = new SimG4DRcaloRunAction(killPolicy,benchmark,profiler); // deleted by G4
+  runAction->setBenchmarkOutput(m_benchmarkOutput);
+  runAction->setFiberLUT(m_fiberLUT);
+  SetUserAction(runAction);
+
   SimG4DRcaloSteppingAction* steppingAction = new SimG4DRcaloSteppingAction(); // deleted by G4
   steppingAction->setSegmentation(pSeg);
   steppingAction->setThreshold(m_thres);
+  steppingAction->setVoxelSize(m_voxelSlice*CLHEP::millimeter,m_voxelXY*CLHEP::millimeter);
+  steppingAction->setFiberAcceptance(m_fiberAcceptance);
+  steppingAction->setPhotonFree(m_photonFree);
+  steppingAction->setFiberEdeps(m_fiberEdeps);
+  steppingAction->setPhotonWeight(m_photonWeight);
+
+  if (m_photonFree) {
+    steppingAction->photonFree().setSDName(m_sdName);
+    steppingAction->photonFree().setScintEff(m_scintEff);
+    steppingAction->photonFree().setCerenEff(m_cerenEff);
+    steppingAction->photonFree().setSignalSpeed(m_signalSpeed*CLHEP::millimeter/CLHEP::ns);
+  }
+
+  if ( killPolicy->isActive() )
+    steppingAction->setKillPolicy(killPolicy);
+
+  steppingAction->setBenchmark(benchmark);
+  steppingAction->setProfiler(profiler);
+
   SetUserAction(steppingAction);
 
+  SimG4DRcaloStackingAction* stackingAction = new SimG4DRcaloStackingAction(); // deleted by G4
+  stackingAction->setApplyFilter(m_applyFilter);
+  stackingAction->setApplyPDE(m_applyPDE);
+  stackingAction->setPhotonWeight(m_photonWeight);
+  stackingAction->setFiberAcceptance(m_fiberAcceptance);
+  stackingAction->setMaxStackedPhotons(m_maxStackedPhotons);
+  stackingAction->setMaxDeferredPhotons(m_maxDeferredPhotons);
+  stackingAction->setSeed(m_seed);
+
+  if ( killPolicy->isActive() )
+    stackingAction->setKillPolicy(killPolicy);
+
+  stackingAction->setBenchmark(benchmark);
+
+  SetUserAction(stackingAction);
+
+  if ( m_maxStackedPhotons > 0 )
+    steppingAction->setStackingAction(stackingAction);
+
   SimG4DRcaloEventAction* eventAction = new SimG4DRcaloEventAction(); // deleted by G4
   eventAction->setSteppingAction(steppingAction);
+  eventAction->setBenchmark(benchmark);
+  eventAction->setProfiler(profiler);
+
+  if (m_showerLibrary) {
+    auto* showerRecorder = new SimG4DRcaloShowerRecorder(m_showerLibrary,pSeg); // deleted by the event action
+    steppingAction->setShowerRecorder(showerRecorder);
+    eventAction->setShowerRecorder(showerRecorder);
+  }
+
   SetUserAction(eventAction);
 
-  G4Material::GetMaterial(m_scintName)->GetIonisation()->SetBirksConstant(m_birks*CLHEP::millimeter/CLHEP::MeV); // makeshift for DD4hep
+  if (m_fiberLUT) {
+    auto* lutRecorder = new SimG4DRcaloFiberLUTRecorder(); // deleted by G4
+    runAction->setFiberLUTRecorder(lutRecorder);
+    SetUserAction(lutRecorder);
+  }
+
+  // sequential run manager, there is no master
+  if ( !G4Threading::IsWorkerThread() )
+    applyBirksConstant();
 }
 }
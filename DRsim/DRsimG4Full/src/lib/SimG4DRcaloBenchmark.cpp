@@ -0,0 +1,101 @@
+#include "SimG4DRcaloBenchmark.h"
+
+#include "G4HCofThisEvent.hh"
+#include "G4Threading.hh"
+
+#include "DRcaloSiPMHit.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+namespace drc {
+
+SimG4DRcaloBenchmarkCounters& SimG4DRcaloBenchmarkCounters::operator+=(const SimG4DRcaloBenchmarkCounters& other) {
+  photonsCreated += other.photonsCreated;
+  photonsTracked += other.photonsTracked;
+  photonsDetected += other.photonsDetected;
+
+  for (const auto& entry : other.steps)
+    steps[entry.first] += entry.second;
+
+  hitArena += other.hitArena;
+
+  return *this;
+}
+
+void SimG4DRcaloBenchmark::countDetected(const G4Event* event) {
+  G4HCofThisEvent* hce = event->GetHCofThisEvent();
+
+  if ( !pCounters || !hce )
+    return;
+
+  for (G4int iColl = 0; iColl < hce->GetNumberOfCollections(); iColl++) {
+    auto* hits = dynamic_cast<DRcaloSiPMHitsCollection*>( hce->GetHC(iColl) );
+
+    if ( !hits || hits->GetSize()==0 )
+      continue;
+
+    for (size_t iHit = 0; iHit < hits->GetSize(); iHit++)
+      pCounters->photonsDetected += static_cast<long>( (*hits)[iHit]->GetPhotonCount() );
+  }
+}
+
+double SimG4DRcaloBenchmark::peakRSS() {
+  struct rusage usage;
+
+  if ( getrusage(RUSAGE_SELF, &usage)!=0 )
+    return 0.;
+
+  return static_cast<double>(usage.ru_maxrss)/1024.; // kB on Linux
+}
+
+bool SimG4DRcaloBenchmark::writeJson(const std::string& filename, const SimG4DRcaloBenchmarkCounters& counters,
+                                     long events, double wallTime, double cpuTime) {
+  std::ofstream out(filename);
+
+  if (!out)
+    return false;
+
+  const double nEvents = static_cast<double>( std::max(events,1L) );
+
+  // by particle name, sorted for a stable output
+  std::map<std::string, long> steps;
+  long totalSteps = 0;
+
+  for (const auto& entry : counters.steps) {
+    steps[ entry.first->GetParticleName() ] += entry.second;
+    totalSteps += entry.second;
+  }
+
+  out << "{" << std::endl;
+  out << "  \"events\": " << events << "," << std::endl;
+  out << "  \"threads\": " << std::max( G4Threading::GetNumberOfRunningWorkerThreads(), 1 ) << "," << std::endl;
+  out << "  \"wallTime\": " << wallTime << "," << std::endl;
+  out << "  \"eventsPerSecond\": " << ( wallTime > 0. ? nEvents/wallTime : 0. ) << "," << std::endl;
+  out << "  \"cpuTimePerEvent\": " << cpuTime/nEvents << "," << std::endl;
+  out << "  \"peakRSSMB\": " << peakRSS() << "," << std::endl;
+  out << "  \"opticalPhotons\": { \"created\": " << counters.photonsCreated << ", \"tracked\": " << counters.photonsTracked
+      << ", \"detected\": " << counters.photonsDetected << " }," << std::endl;
+  const DRcaloArenaStats& arena = counters.hitArena;
+  const double fragmentation = arena.bytesReserved > 0 ? 1. - static_cast<double>(arena.bytesRequested)/static_cast<double>(arena.bytesReserved) : 0.;
+
+  out << "  \"hitArena\": { \"events\": " << arena.events << ", \"allocations\": " << arena.allocations
+      << ", \"bytesRequested\": " << arena.bytesRequested << ", \"bytesReserved\": " << arena.bytesReserved
+      << ", \"fragmentation\": " << fragmentation << ", \"peakEventBytes\": " << arena.peakEventBytes
+      << ", \"chunks\": " << arena.chunks << ", \"allocatorTime\": " << arena.allocatorTime << " }," << std::endl;
+  out << "  \"steps\": {" << std::endl;
+  out << "    \"total\": " << totalSteps;
+
+  for (const auto& entry : steps)
+    out << "," << std::endl << "    \"" << entry.first << "\": " << entry.second;
+
+  out << std::endl << "  }" << std::endl;
+  out << "}" << std::endl;
+
+  return out.good();
+}
+
+} // namespace drc
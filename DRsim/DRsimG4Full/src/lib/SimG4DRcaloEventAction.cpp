@@ -1,23 +1,42 @@
 #include "SimG4DRcaloEventAction.h"
+#include "SimG4DRcaloEventInformation.h"
 
-#include "G4RunManager.hh"
+#include "G4EventManager.hh"
 
 namespace drc {
-SimG4DRcaloEventAction::SimG4DRcaloEventAction(): G4UserEventAction() {}
+SimG4DRcaloEventAction::SimG4DRcaloEventAction(): G4UserEventAction(), pSteppingAction(nullptr), pBenchmark(nullptr), pProfiler(nullptr) {}
 
 SimG4DRcaloEventAction::~SimG4DRcaloEventAction() {}
 
 void SimG4DRcaloEventAction::BeginOfEventAction(const G4Event*) {
-  m_Edeps = new edm4hep::SimCalorimeterHitCollection();
-  m_Edeps3d = new edm4hep::SimCalorimeterHitCollection();
-  m_Leakages = new edm4hep::MCParticleCollection();
+  auto* info = new SimG4DRcaloEventInformation(); // deleted with the event
+  G4EventManager::GetEventManager()->SetUserInformation(info);
 
-  pSteppingAction->setEdepsCollection(m_Edeps);
-  pSteppingAction->setEdeps3dCollection(m_Edeps3d);
-  pSteppingAction->setLeakagesCollection(m_Leakages);
+  pSteppingAction->setEdepsCollection(info->edeps());
+  pSteppingAction->setEdeps3dCollection(info->edeps3d());
+  pSteppingAction->setLeakagesCollection(info->leakages());
+  pSteppingAction->setFiberEdepsCollection(info->fiberEdeps());
+
+  if (fShowerRecorder)
+    fShowerRecorder->beginEvent();
+
+  // the time before the first step of the event is not a step
+  if (pProfiler)
+    pProfiler->beginEvent();
 
   return;
 }
 
-void SimG4DRcaloEventAction::EndOfEventAction(const G4Event*) {}
+void SimG4DRcaloEventAction::EndOfEventAction(const G4Event* event) {
+  pSteppingAction->flushEdeps();
+
+  // the SiPM hits are complete, the SDs are closed before the event action
+  if (fShowerRecorder)
+    fShowerRecorder->endEvent(event);
+
+  if (pBenchmark)
+    pBenchmark->countDetected(event);
+
+  return;
+}
 } // namespace drc
@@ -0,0 +1,22 @@
+#include "SimG4DRcaloEventInformation.h"
+
+#include "G4ios.hh"
+
+namespace drc {
+
+SimG4DRcaloEventInformation::SimG4DRcaloEventInformation()
+: G4VUserEventInformation(),
+  m_Edeps(std::make_unique<edm4hep::SimCalorimeterHitCollection>()),
+  m_Edeps3d(std::make_unique<edm4hep::SimCalorimeterHitCollection>()),
+  m_Leakages(std::make_unique<edm4hep::MCParticleCollection>()),
+  m_FiberEdeps(std::make_unique<edm4hep::SimCalorimeterHitCollection>()) {}
+
+void SimG4DRcaloEventInformation::Print() const {
+  G4cout << "SimG4DRcaloEventInformation: "
+         << ( m_Edeps ? m_Edeps->size() : 0 ) << " SimCalorimeterHits, "
+         << ( m_Edeps3d ? m_Edeps3d->size() : 0 ) << " Sim3dCalorimeterHits, "
+         << ( m_Leakages ? m_Leakages->size() : 0 ) << " Leakages, "
+         << ( m_FiberEdeps ? m_FiberEdeps->size() : 0 ) << " SimFiberCalorimeterHits" << G4endl;
+}
+
+} // namespace drc
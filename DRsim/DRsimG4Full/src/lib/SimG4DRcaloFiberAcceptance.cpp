@@ -0,0 +1,137 @@
+#include "SimG4DRcaloFiberAcceptance.h"
+
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Tubs.hh"
+#include "G4Material.hh"
+#include "G4GeometryTolerance.hh"
+
+namespace {
+  bool startsWith(const G4String& name, const char* prefix) { return name.rfind(prefix,0)==0; }
+
+  G4MaterialPropertyVector* rindex(const G4LogicalVolume* lv) {
+    auto* mpt = lv->GetMaterial()->GetMaterialPropertiesTable();
+
+    return mpt ? mpt->GetProperty(kRINDEX) : nullptr;
+  }
+
+  double radius(const G4LogicalVolume* lv) {
+    auto* tubs = dynamic_cast<const G4Tubs*>( lv->GetSolid() );
+
+    return tubs ? tubs->GetOuterRadius() : 0.;
+  }
+}
+
+namespace drc {
+
+bool SimG4DRcaloFiberAcceptance::isTrapped(const G4Track* track) {
+  const G4VTouchable* touchable = track->GetTouchable();
+
+  if ( !touchable || touchable->GetHistoryDepth() < 2 )
+    return true;
+
+  const FiberInfo& info = fiberInfo(touchable);
+
+  if ( !info.isFiber )
+    return true;
+
+  // core shares the frame of the cladding, z is the fiber axis toward the SiPM
+  const G4AffineTransform& transform = touchable->GetHistory()->GetTopTransform();
+  G4ThreeVector pos = transform.TransformPoint( track->GetPosition() );
+  G4ThreeVector dir = transform.TransformAxis( track->GetMomentumDirection() );
+
+  // the scintillation fiber is terminated by a dark cap
+  if ( info.isScint && dir.z() < 0. )
+    return false;
+
+  double photonMomentum = track->GetDynamicParticle()->GetTotalMomentum();
+  double nBirth = info.rindexBirth->Value(photonMomentum);
+  double beta = nBirth*dir.z();
+  double angMom = nBirth*( pos.x()*dir.y() - pos.y()*dir.x() );
+  double invariant = beta*beta;
+
+  if ( info.inCore ) {
+    double nClad = info.rindexClad->Value(photonMomentum);
+
+    if ( invariant + angMom*angMom/(info.rCore*info.rCore) > nClad*nClad )
+      return true;
+  }
+
+  // cladding mode
+  double nOut = info.rindexOut ? info.rindexOut->Value(photonMomentum) : 1.;
+
+  return invariant + angMom*angMom/(info.rClad*info.rClad) > nOut*nOut;
+}
+
+bool SimG4DRcaloFiberAcceptance::isEscaping(const G4Step* step) {
+  const G4StepPoint* postStepPoint = step->GetPostStepPoint();
+
+  if ( postStepPoint->GetStepStatus() != fGeomBoundary || !postStepPoint->GetPhysicalVolume() )
+    return false;
+
+  const G4LogicalVolume* lv = postStepPoint->GetPhysicalVolume()->GetLogicalVolume();
+  EnvType type = envType(lv);
+
+  if ( type==EnvType::kAirHole )
+    return true;
+
+  if ( type==EnvType::kFiberEnv ) {
+    // the top face of the envelope touches the SiPM, do not kill photons leaving the fiber end
+    G4ThreeVector local = postStepPoint->GetTouchable()->GetHistory()->GetTopTransform().TransformPoint( postStepPoint->GetPosition() );
+    auto* tubs = dynamic_cast<const G4Tubs*>( lv->GetSolid() );
+    double tolerance = G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+
+    return tubs && local.z() < tubs->GetZHalfLength() - tolerance;
+  }
+
+  return false;
+}
+
+const SimG4DRcaloFiberAcceptance::FiberInfo& SimG4DRcaloFiberAcceptance::fiberInfo(const G4VTouchable* touchable) {
+  const G4LogicalVolume* lv = touchable->GetVolume(0)->GetLogicalVolume();
+  auto found = fFiberInfos.find(lv);
+
+  if ( found!=fFiberInfos.end() )
+    return found->second;
+
+  FiberInfo info;
+  const G4String& name = lv->GetName();
+  bool isCore = startsWith(name,"coreC") || startsWith(name,"coreS");
+  bool isClad = startsWith(name,"cladC") || startsWith(name,"cladS");
+
+  // fiberEnv > clad > core
+  if ( ( isCore && touchable->GetHistoryDepth() >= 2 ) || isClad ) {
+    const G4LogicalVolume* cladLV = isCore ? touchable->GetVolume(1)->GetLogicalVolume() : lv;
+    const G4LogicalVolume* envLV = touchable->GetVolume( isCore ? 2 : 1 )->GetLogicalVolume();
+
+    info.inCore = isCore;
+    info.isScint = startsWith(name,"coreS") || startsWith(name,"cladS");
+    info.rCore = isCore ? radius(lv) : 0.;
+    info.rClad = radius(cladLV);
+    info.rindexBirth = rindex(lv);
+    info.rindexClad = rindex(cladLV);
+    info.rindexOut = rindex(envLV);
+    info.isFiber = info.rindexBirth && info.rindexClad && info.rClad > 0. && ( !isCore || info.rCore > 0. );
+  }
+
+  return fFiberInfos.emplace(lv,info).first->second;
+}
+
+SimG4DRcaloFiberAcceptance::EnvType SimG4DRcaloFiberAcceptance::envType(const G4LogicalVolume* lv) {
+  auto found = fEnvTypes.find(lv);
+
+  if ( found!=fEnvTypes.end() )
+    return found->second;
+
+  EnvType type = EnvType::kNone;
+
+  if ( startsWith(lv->GetName(),"fiberEnv") )
+    type = EnvType::kFiberEnv;
+  else if ( startsWith(lv->GetName(),"airHole") )
+    type = EnvType::kAirHole;
+
+  return fEnvTypes.emplace(lv,type).first->second;
+}
+
+} // namespace drc
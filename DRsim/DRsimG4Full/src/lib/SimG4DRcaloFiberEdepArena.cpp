@@ -0,0 +1,41 @@
+#include "SimG4DRcaloFiberEdepArena.h"
+
+namespace drc {
+
+void SimG4DRcaloFiberEdepArena::add(dd4hep::DDSegmentation::CellID tower, int numX, int numY, int x, int y,
+                                    dd4hep::DDSegmentation::CellID sipm, float edep) {
+  auto found = fBlocks.find(tower);
+
+  if ( found==fBlocks.end() ) {
+    found = fBlocks.emplace(tower,fUsed).first;
+    fUsed += static_cast<size_t>(numX*numY);
+
+    if ( fPool.size() < fUsed ) {
+      fPool.resize(fUsed,0.f);
+      fCellIDs.resize(fUsed,0);
+    }
+  }
+
+  if ( x < 0 || x >= numX || y < 0 || y >= numY )
+    return;
+
+  const size_t slot = found->second + static_cast<size_t>(x*numY + y);
+
+  if ( fPool[slot]==0.f ) {
+    fOccupied.push_back(slot);
+    fCellIDs[slot] = sipm;
+  }
+
+  fPool[slot] += edep;
+}
+
+void SimG4DRcaloFiberEdepArena::reset() {
+  for (size_t slot : fOccupied)
+    fPool[slot] = 0.f;
+
+  fOccupied.clear();
+  fBlocks.clear();
+  fUsed = 0;
+}
+
+} // namespace drc
@@ -0,0 +1,57 @@
+#include "SimG4DRcaloFiberLUTRecorder.h"
+
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTypes.hh"
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+#include "G4Tubs.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+namespace drc {
+
+SimG4DRcaloFiberLUTRecorder::SimG4DRcaloFiberLUTRecorder()
+: G4UserTrackingAction(), pLUT(nullptr), fBornInCore(false), fIsCerenkov(false), fDist(0.), fCosTheta(0.), fWavlen(0.) {}
+
+SimG4DRcaloFiberLUTRecorder::~SimG4DRcaloFiberLUTRecorder() {}
+
+void SimG4DRcaloFiberLUTRecorder::PreUserTrackingAction(const G4Track* track) {
+  fBornInCore = false;
+
+  if ( !pLUT || track->GetDefinition() != G4OpticalPhoton::OpticalPhotonDefinition() )
+    return;
+
+  const G4VTouchable* touchable = track->GetTouchable();
+  const G4String& name = touchable->GetVolume()->GetLogicalVolume()->GetName();
+
+  if ( name.rfind("coreC",0)!=0 && name.rfind("coreS",0)!=0 )
+    return;
+
+  auto* tubs = dynamic_cast<const G4Tubs*>( touchable->GetSolid() );
+
+  if (!tubs)
+    return;
+
+  const G4AffineTransform& toLocal = touchable->GetHistory()->GetTopTransform();
+  G4ThreeVector pos = toLocal.TransformPoint( track->GetPosition() );
+  G4ThreeVector dir = toLocal.TransformAxis( track->GetMomentumDirection() );
+
+  fBornInCore = true;
+  fIsCerenkov = ( name.rfind("coreC",0)==0 );
+  fCosTheta = dir.z();
+  fDist = pLUT->unfoldedDistance( pos.z()/mm, tubs->GetZHalfLength()/mm, fCosTheta );
+  fWavlen = h_Planck*c_light/track->GetTotalEnergy()/nm;
+}
+
+void SimG4DRcaloFiberLUTRecorder::PostUserTrackingAction(const G4Track* track) {
+  if (!fBornInCore)
+    return;
+
+  // detected photons end their life at the SiPM wafer
+  auto* lastVolume = track->GetStep()->GetPostStepPoint()->GetPhysicalVolume();
+  bool arrived = lastVolume && lastVolume->GetLogicalVolume()->GetName().rfind("sipmWafer",0)==0;
+
+  pLUT->fill( fIsCerenkov, fDist, fCosTheta, fWavlen, arrived, track->GetLocalTime()/ns, track->GetWeight() );
+}
+
+} // namespace drc
@@ -0,0 +1,90 @@
+#include "SimG4DRcaloKillPolicy.h"
+
+#include "G4ParticleDefinition.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <iomanip>
+
+namespace drc {
+
+void SimG4DRcaloKillCounters::count(Reason reason, int pdg, double ekin) {
+  auto& entry = byPDG[pdg].at(reason);
+  entry.tracks++;
+  entry.energy += ekin;
+}
+
+SimG4DRcaloKillCounters& SimG4DRcaloKillCounters::operator+=(const SimG4DRcaloKillCounters& other) {
+  for (const auto& pdg : other.byPDG) {
+    auto& mine = byPDG[pdg.first];
+
+    for (int reason = 0; reason < kNumReasons; reason++) {
+      mine.at(reason).tracks += pdg.second.at(reason).tracks;
+      mine.at(reason).energy += pdg.second.at(reason).energy;
+    }
+  }
+
+  return *this;
+}
+
+void SimG4DRcaloKillCounters::print(std::ostream& out) const {
+  const char* names[kNumReasons] = { "time cut", "neutron time cut", "energy cut" };
+
+  out << "  killed tracks by PDG code (kinetic energy not tracked in MeV)" << std::endl;
+
+  for (const auto& pdg : byPDG) {
+    out << "    " << std::setw(11) << pdg.first;
+
+    for (int reason = 0; reason < kNumReasons; reason++) {
+      if ( pdg.second.at(reason).tracks > 0 )
+        out << "  " << names[reason] << " " << pdg.second.at(reason).tracks << " (" << pdg.second.at(reason).energy/MeV << ")";
+    }
+
+    out << std::endl;
+  }
+}
+
+SimG4DRcaloKillPolicy::SimG4DRcaloKillPolicy()
+: fTimeCut(0.), fNeutronTimeCut(0.), pCounters(nullptr) {}
+
+bool SimG4DRcaloKillPolicy::killAtBirth(const G4Track* track) {
+  if ( killInFlight(track) )
+    return true;
+
+  // primaries are never cut
+  if ( fEnergyCuts.empty() || track->GetParentID()==0 )
+    return false;
+
+  auto cut = fEnergyCuts.find( track->GetDefinition()->GetPDGEncoding() );
+
+  if ( cut==fEnergyCuts.end() || track->GetKineticEnergy() >= cut->second )
+    return false;
+
+  count(SimG4DRcaloKillCounters::kEnergy, track);
+
+  return true;
+}
+
+bool SimG4DRcaloKillPolicy::killLate(const G4Track* track) {
+  const double time = track->GetGlobalTime();
+
+  if ( fTimeCut > 0. && time > fTimeCut ) {
+    count(SimG4DRcaloKillCounters::kTime, track);
+
+    return true;
+  }
+
+  if ( fNeutronTimeCut > 0. && time > fNeutronTimeCut && track->GetDefinition()->GetPDGEncoding()==2112 ) {
+    count(SimG4DRcaloKillCounters::kNeutronTime, track);
+
+    return true;
+  }
+
+  return false;
+}
+
+void SimG4DRcaloKillPolicy::count(SimG4DRcaloKillCounters::Reason reason, const G4Track* track) {
+  if (pCounters)
+    pCounters->count( reason, track->GetDefinition()->GetPDGEncoding(), track->GetKineticEnergy() );
+}
+
+} // namespace drc
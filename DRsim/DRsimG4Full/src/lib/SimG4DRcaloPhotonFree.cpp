@@ -0,0 +1,202 @@
+#include "SimG4DRcaloPhotonFree.h"
+
+#include "G4SDManager.hh"
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+#include "G4Tubs.hh"
+#include "G4Material.hh"
+#include "G4Poisson.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace drc {
+
+SimG4DRcaloPhotonFree::SimG4DRcaloPhotonFree()
+: fSDName("DRcalo"), pSD(nullptr), fScintEff(0.), fCerenEff(0.), fSignalSpeed(c_light) {}
+
+void SimG4DRcaloPhotonFree::convert(const G4Step* step) {
+  const G4StepPoint* presteppoint = step->GetPreStepPoint();
+  const G4StepPoint* poststeppoint = step->GetPostStepPoint();
+  const double charge = step->GetTrack()->GetDefinition()->GetPDGCharge()/eplus;
+  const double stepLength = step->GetStepLength();
+
+  if ( charge==0. || stepLength <= 0. )
+    return;
+
+  const G4VTouchable* touchable = presteppoint->GetTouchable();
+
+  if ( touchable->GetHistoryDepth() < 3 )
+    return;
+
+  const CoreInfo& info = coreInfo( touchable->GetVolume()->GetLogicalVolume() );
+
+  if (!info.isCore)
+    return;
+
+  const double beta = 0.5*( presteppoint->GetBeta() + poststeppoint->GetBeta() );
+  double meanPE = 0.;
+
+  if (info.isCerenkov) {
+    meanPE = frankTamm(info,beta)*charge*charge*stepLength*fCerenEff;
+  } else {
+    double edep = step->GetTotalEnergyDeposit() - step->GetNonIonizingEnergyDeposit();
+    double birks = presteppoint->GetMaterial()->GetIonisation()->GetBirksConstant();
+    double visible = edep/( 1. + birks*edep/stepLength );
+
+    meanPE = info.scintYield*visible*fScintEff;
+  }
+
+  if ( meanPE <= 0. )
+    return;
+
+  G4long nPE = G4Poisson(meanPE);
+
+  if ( nPE==0 )
+    return;
+
+  // photoelectrons start at the middle of the step and propagate to the SiPM along the fiber
+  G4ThreeVector mid = 0.5*( presteppoint->GetPosition() + poststeppoint->GetPosition() );
+  double localZ = touchable->GetHistory()->GetTopTransform().TransformPoint(mid).z();
+  double arrival = 0.5*( presteppoint->GetGlobalTime() + poststeppoint->GetGlobalTime() ) + ( info.halfZ - localZ )/fSignalSpeed;
+
+  auto* sd = sensitiveDetector();
+  auto cID = sd->fiberCellID(touchable);
+
+  fTimes.resize(nPE);
+  fEnergies.resize(nPE);
+  fWeights.assign(nPE,1);
+
+  for (G4long iPE = 0; iPE < nPE; iPE++) {
+    double time = arrival;
+
+    if ( !info.isCerenkov && info.scintTime > 0. )
+      time += CLHEP::RandExponential::shoot(info.scintTime);
+
+    fTimes[iPE] = time;
+    fEnergies[iPE] = info.isCerenkov ? sampleCerenkovEnergy(info,beta) : sampleScintEnergy(info);
+  }
+
+  sd->addPhotons(cID, fTimes.size(), fTimes.data(), fEnergies.data(), fWeights.data());
+}
+
+double SimG4DRcaloPhotonFree::frankTamm(const CoreInfo& info, double beta) const {
+  if ( !info.rindex || info.rindex->GetVectorLength() < 2 )
+    return 0.;
+
+  // integrate 1 - 1/(beta n)^2 over the photon energy where beta n > 1
+  double integral = 0.;
+
+  for (size_t idx = 0; idx+1 < info.rindex->GetVectorLength(); idx++) {
+    double e0 = info.rindex->Energy(idx);
+    double e1 = info.rindex->Energy(idx+1);
+    double n0 = (*info.rindex)[idx];
+    double n1 = (*info.rindex)[idx+1];
+    double f0 = 1. - 1./(beta*beta*n0*n0);
+    double f1 = 1. - 1./(beta*beta*n1*n1);
+
+    if ( f0 <= 0. && f1 <= 0. )
+      continue;
+
+    if ( f0 > 0. && f1 > 0. ) {
+      integral += 0.5*(f0+f1)*(e1-e0);
+      continue;
+    }
+
+    // threshold inside the interval
+    double threshold = e0 + (1./beta - n0)/(n1 - n0)*(e1 - e0);
+    integral += ( f0 > 0. ) ? 0.5*f0*(threshold-e0) : 0.5*f1*(e1-threshold);
+  }
+
+  return fine_structure_const/hbarc*integral;
+}
+
+double SimG4DRcaloPhotonFree::sampleCerenkovEnergy(const CoreInfo& info, double beta) const {
+  const double eMin = info.rindex->GetMinEnergy();
+  const double eMax = info.rindex->GetMaxEnergy();
+  const double nMax = info.rindex->GetMaxValue();
+  const double fMax = 1. - 1./(beta*beta*nMax*nMax);
+  double energy = eMin;
+
+  // dN/dE is flat up to sin^2 of the Cherenkov angle
+  for (int iTry = 0; iTry < 100; iTry++) {
+    energy = eMin + G4UniformRand()*(eMax - eMin);
+    double n = info.rindex->Value(energy);
+
+    if ( G4UniformRand()*fMax < 1. - 1./(beta*beta*n*n) )
+      break;
+  }
+
+  return energy;
+}
+
+double SimG4DRcaloPhotonFree::sampleScintEnergy(const CoreInfo& info) const {
+  G4MaterialPropertyVector* spectrum = info.scintSpectrum ? info.scintSpectrum : info.rindex;
+
+  if (!spectrum)
+    return h_Planck*c_light/(450.*nm);
+
+  const double eMin = spectrum->GetMinEnergy();
+  const double eMax = spectrum->GetMaxEnergy();
+  double energy = eMin;
+
+  for (int iTry = 0; iTry < 100; iTry++) {
+    energy = eMin + G4UniformRand()*(eMax - eMin);
+
+    if ( !info.scintSpectrum || G4UniformRand()*spectrum->GetMaxValue() < spectrum->Value(energy) )
+      break;
+  }
+
+  return energy;
+}
+
+const SimG4DRcaloPhotonFree::CoreInfo& SimG4DRcaloPhotonFree::coreInfo(const G4LogicalVolume* lv) {
+  auto found = fCoreInfos.find(lv);
+
+  if ( found!=fCoreInfos.end() )
+    return found->second;
+
+  CoreInfo info;
+  const G4String& name = lv->GetName();
+  auto* tubs = dynamic_cast<const G4Tubs*>( lv->GetSolid() );
+
+  if ( tubs && ( name.rfind("coreC",0)==0 || name.rfind("coreS",0)==0 ) ) {
+    info.isCore = true;
+    info.isCerenkov = ( name.rfind("coreC",0)==0 );
+    info.halfZ = tubs->GetZHalfLength();
+
+    auto* mpt = lv->GetMaterial()->GetMaterialPropertiesTable();
+
+    if (mpt) {
+      info.rindex = mpt->GetProperty(kRINDEX);
+      info.scintSpectrum = mpt->GetProperty(kSCINTILLATIONCOMPONENT1);
+
+      if ( mpt->ConstPropertyExists(kSCINTILLATIONYIELD) )
+        info.scintYield = mpt->GetConstProperty(kSCINTILLATIONYIELD);
+
+      if ( mpt->ConstPropertyExists(kSCINTILLATIONTIMECONSTANT1) )
+        info.scintTime = mpt->GetConstProperty(kSCINTILLATIONTIMECONSTANT1);
+    }
+  }
+
+  return fCoreInfos.emplace(lv,info).first->second;
+}
+
+DRcaloSiPMSD* SimG4DRcaloPhotonFree::sensitiveDetector() {
+  if (pSD)
+    return pSD;
+
+  // SDs are thread-local, look up the one of this thread
+  pSD = dynamic_cast<DRcaloSiPMSD*>( G4SDManager::GetSDMpointer()->FindSensitiveDetector(fSDName,false) );
+
+  if (!pSD)
+    throw std::runtime_error("SimG4DRcaloPhotonFree: unable to find DRcaloSiPMSD " + fSDName);
+
+  return pSD;
+}
+
+} // namespace drc
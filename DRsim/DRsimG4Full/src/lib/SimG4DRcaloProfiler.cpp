@@ -0,0 +1,138 @@
+#include "SimG4DRcaloProfiler.h"
+
+#include "G4ParticleDefinition.hh"
+#include "G4OpticalPhoton.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+namespace drc {
+
+SimG4DRcaloProfileCounters& SimG4DRcaloProfileCounters::operator+=(const SimG4DRcaloProfileCounters& other) {
+  for (const auto& table : { std::make_pair(&byVolume,&other.byVolume), std::make_pair(&byParticle,&other.byParticle), std::make_pair(&byProcess,&other.byProcess) }) {
+    for (const auto& entry : *table.second) {
+      auto& mine = (*table.first)[entry.first];
+      mine.steps += entry.second.steps;
+      mine.time += entry.second.time;
+    }
+  }
+
+  return *this;
+}
+
+void SimG4DRcaloProfileCounters::print(std::ostream& out) const {
+  double total = 0.;
+
+  for (const auto& entry : byParticle)
+    total += entry.second.time;
+
+  const std::pair<const char*, const std::map<std::string, Entry>*> tables[] = {
+    { "volume type", &byVolume }, { "particle type", &byParticle }, { "process limiting the step", &byProcess }
+  };
+
+  out << "  profile of the steps, wall time " << total << " s" << std::endl;
+
+  for (const auto& table : tables) {
+    std::vector<std::pair<std::string, Entry>> ranked( table.second->begin(), table.second->end() );
+    std::sort( ranked.begin(), ranked.end(), [](const std::pair<std::string, Entry>& a, const std::pair<std::string, Entry>& b) { return a.second.time > b.second.time; } );
+
+    out << "    by " << table.first << std::endl;
+
+    for (const auto& entry : ranked) {
+      out << "      " << std::left << std::setw(32) << entry.first << std::right
+          << std::setw(14) << entry.second.steps << " steps "
+          << std::setw(11) << std::setprecision(4) << entry.second.time << " s "
+          << std::setw(6) << std::setprecision(3) << ( total > 0. ? 100.*entry.second.time/total : 0. ) << " % "
+          << std::setw(9) << std::setprecision(3) << ( entry.second.steps > 0 ? 1.e6*entry.second.time/static_cast<double>(entry.second.steps) : 0. ) << " us/step"
+          << std::endl;
+    }
+  }
+
+  out << std::setprecision(6);
+}
+
+SimG4DRcaloProfiler::SimG4DRcaloProfiler()
+: pCounters(nullptr), fLast(std::chrono::steady_clock::now()) {
+  std::fill( fParticles, fParticles+kNumParticleTypes, nullptr );
+}
+
+void SimG4DRcaloProfiler::setCounters(SimG4DRcaloProfileCounters* counters) {
+  pCounters = counters;
+  fVolumes.clear();
+  fProcesses.clear();
+
+  if (!pCounters) {
+    std::fill( fParticles, fParticles+kNumParticleTypes, nullptr );
+
+    return;
+  }
+
+  fParticles[kOptical] = &pCounters->byParticle["optical photon"];
+  fParticles[kCharged] = &pCounters->byParticle["charged"];
+  fParticles[kNeutral] = &pCounters->byParticle["neutral"];
+}
+
+void SimG4DRcaloProfiler::profile(const G4Step* step) {
+  if (!pCounters)
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+  const double time = std::chrono::duration<double>(now - fLast).count();
+  fLast = now;
+
+  const G4ParticleDefinition* particle = step->GetTrack()->GetDefinition();
+  ParticleType type = kNeutral;
+
+  if ( particle==G4OpticalPhoton::OpticalPhotonDefinition() )
+    type = kOptical;
+  else if ( particle->GetPDGCharge()!=0. )
+    type = kCharged;
+
+  Entry* entries[3] = { fParticles[type],
+                        volumeEntry( step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume() ),
+                        processEntry( step->GetPostStepPoint()->GetProcessDefinedStep() ) };
+
+  for (auto* entry : entries) {
+    entry->steps++;
+    entry->time += time;
+  }
+}
+
+SimG4DRcaloProfiler::Entry* SimG4DRcaloProfiler::volumeEntry(const G4LogicalVolume* lv) {
+  auto found = fVolumes.find(lv);
+
+  if ( found!=fVolumes.end() )
+    return found->second;
+
+  Entry* entry = &pCounters->byVolume[ volumeType(lv->GetName()) ];
+  fVolumes.emplace(lv,entry);
+
+  return entry;
+}
+
+SimG4DRcaloProfiler::Entry* SimG4DRcaloProfiler::processEntry(const G4VProcess* process) {
+  auto found = fProcesses.find(process);
+
+  if ( found!=fProcesses.end() )
+    return found->second;
+
+  Entry* entry = &pCounters->byProcess[ process ? static_cast<std::string>( process->GetProcessName() ) : "none" ];
+  fProcesses.emplace(process,entry);
+
+  return entry;
+}
+
+std::string SimG4DRcaloProfiler::volumeType(const std::string& name) {
+  static const char* types[] = { "tower", "fullBox", "unitBox", "fiberEnv", "airHole", "cladC", "cladS", "coreC", "coreS", "capC", "capS",
+                                 "sipmLayer", "sipmWafer", "sipmFullBox", "sipmUnitBox", "sipmEnvelop", "assembly" };
+
+  for (const char* type : types) {
+    if ( name.rfind(type,0)==0 )
+      return type;
+  }
+
+  return name;
+}
+
+} // namespace drc
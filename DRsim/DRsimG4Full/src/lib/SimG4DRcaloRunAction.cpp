@@ -0,0 +1,104 @@
+#include "SimG4DRcaloRunAction.h"
+
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+namespace drc {
+
+void SimG4DRcaloRun::Merge(const G4Run* run) {
+  const auto* drcRun = dynamic_cast<const SimG4DRcaloRun*>(run);
+
+  if (drcRun) {
+    fKillCounters += drcRun->fKillCounters;
+    fBenchmarkCounters += drcRun->fBenchmarkCounters;
+    fProfileCounters += drcRun->fProfileCounters;
+
+    if ( fFiberLUT && drcRun->fFiberLUT )
+      fFiberLUT->add(*drcRun->fFiberLUT);
+  }
+
+  G4Run::Merge(run);
+}
+
+SimG4DRcaloRunAction::SimG4DRcaloRunAction(SimG4DRcaloKillPolicy* policy, SimG4DRcaloBenchmark* benchmark, SimG4DRcaloProfiler* profiler)
+: G4UserRunAction(), fPolicy(policy), fBenchmark(benchmark), fProfiler(profiler), pFiberLUT(nullptr), pFiberLUTRecorder(nullptr) {}
+
+G4Run* SimG4DRcaloRunAction::GenerateRun() {
+  auto* run = new SimG4DRcaloRun(); // deleted by G4
+
+  // each thread fills a table of its own, summed by Merge()
+  if (pFiberLUT)
+    run->setFiberLUT( std::make_unique<DRcaloFiberLUT>( pFiberLUT->emptyCopy() ) );
+
+  return run;
+}
+
+void SimG4DRcaloRunAction::BeginOfRunAction(const G4Run* run) {
+  if (fPolicy)
+    fPolicy->setCounters( &static_cast<SimG4DRcaloRun*>( const_cast<G4Run*>(run) )->killCounters() );
+
+  if (fBenchmark)
+    fBenchmark->setCounters( &static_cast<SimG4DRcaloRun*>( const_cast<G4Run*>(run) )->benchmarkCounters() );
+
+  if (fProfiler)
+    fProfiler->setCounters( &static_cast<SimG4DRcaloRun*>( const_cast<G4Run*>(run) )->profileCounters() );
+
+  if (pFiberLUTRecorder)
+    pFiberLUTRecorder->setTable( static_cast<SimG4DRcaloRun*>( const_cast<G4Run*>(run) )->fiberLUT() );
+
+  fTimer.Start();
+}
+
+void SimG4DRcaloRunAction::EndOfRunAction(const G4Run* run) {
+  fTimer.Stop();
+
+  if (fPolicy)
+    fPolicy->setCounters(nullptr);
+
+  if (fBenchmark)
+    fBenchmark->setCounters(nullptr);
+
+  if (fProfiler)
+    fProfiler->setCounters(nullptr);
+
+  if (pFiberLUTRecorder)
+    pFiberLUTRecorder->setTable(nullptr);
+
+  // the workers are merged into the master
+  if ( G4Threading::IsWorkerThread() )
+    return;
+
+  auto* fiberLUT = static_cast<SimG4DRcaloRun*>( const_cast<G4Run*>(run) )->fiberLUT();
+
+  if ( pFiberLUT && fiberLUT )
+    pFiberLUT->add(*fiberLUT);
+
+  if ( run->GetNumberOfEvent()==0 )
+    return;
+
+  auto& counters = static_cast<SimG4DRcaloRun*>( const_cast<G4Run*>(run) )->killCounters();
+
+  G4cout << "SimG4DRcaloRunAction: run " << run->GetRunID() << ", " << run->GetNumberOfEvent() << " events, "
+         << fTimer.GetRealElapsed()/static_cast<double>(run->GetNumberOfEvent()) << " s (wall clock) & "
+         << fTimer.GetUserElapsed()/static_cast<double>(run->GetNumberOfEvent()) << " s (CPU of the process) per event" << G4endl;
+
+  if ( !counters.empty() )
+    counters.print(G4cout);
+
+  auto& profile = static_cast<SimG4DRcaloRun*>( const_cast<G4Run*>(run) )->profileCounters();
+
+  if ( !profile.empty() )
+    profile.print(G4cout);
+
+  if ( fBenchmarkOutput.empty() )
+    return;
+
+  auto& benchmarkCounters = static_cast<SimG4DRcaloRun*>( const_cast<G4Run*>(run) )->benchmarkCounters();
+
+  if ( SimG4DRcaloBenchmark::writeJson(fBenchmarkOutput, benchmarkCounters, run->GetNumberOfEvent(), fTimer.GetRealElapsed(), fTimer.GetUserElapsed()) )
+    G4cout << "SimG4DRcaloRunAction: benchmark of run " << run->GetRunID() << " is written to " << fBenchmarkOutput << G4endl;
+  else
+    G4cerr << "SimG4DRcaloRunAction: unable to write the benchmark to " << fBenchmarkOutput << G4endl;
+}
+
+} // namespace drc
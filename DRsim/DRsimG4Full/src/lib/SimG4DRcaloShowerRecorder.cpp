@@ -0,0 +1,90 @@
+#include "SimG4DRcaloShowerRecorder.h"
+
+#include "DRcaloSiPMHit.h"
+
+#include "G4HCofThisEvent.hh"
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+
+#include "DD4hep/DD4hepUnits.h"
+
+namespace {
+  G4Mutex libraryMutex = G4MUTEX_INITIALIZER;
+}
+
+namespace drc {
+
+SimG4DRcaloShowerRecorder::SimG4DRcaloShowerRecorder(DRcaloShowerLibrary* library, dd4hep::DDSegmentation::GridDRcalo* seg)
+: pLibrary(library), pSeg(seg), fHasEntry(false), fTowerNum32(0), fTime(0.), fEnergy(0.) {}
+
+void SimG4DRcaloShowerRecorder::recordEntry(const G4Step* step) {
+  if ( fHasEntry || step->GetTrack()->GetParentID()!=0 )
+    return;
+
+  const G4StepPoint* presteppoint = step->GetPreStepPoint();
+  const G4VTouchable* touchable = presteppoint->GetTouchable();
+  const int towerLevel = 2;
+
+  // world > assembly > tower
+  if ( touchable->GetHistoryDepth() < towerLevel )
+    return;
+
+  const G4NavigationHistory* history = touchable->GetHistory();
+
+  if ( history->GetVolume(towerLevel)->GetLogicalVolume()->GetName().rfind("tower",0)!=0 )
+    return;
+
+  fHasEntry = true;
+  fTowerNum32 = history->GetReplicaNo(towerLevel);
+  fToTower = history->GetTransform(towerLevel);
+  fLocalPos = fToTower.TransformPoint( presteppoint->GetPosition() );
+  fLocalDir = fToTower.TransformAxis( presteppoint->GetMomentumDirection() );
+  fTime = presteppoint->GetGlobalTime();
+  fEnergy = presteppoint->GetKineticEnergy();
+}
+
+void SimG4DRcaloShowerRecorder::endEvent(const G4Event* event) {
+  G4HCofThisEvent* hce = event->GetHCofThisEvent();
+
+  if ( !fHasEntry || !hce )
+    return;
+
+  DRcaloShowerLibrary::Shower shower;
+  int numEta = pSeg->numEta( pSeg->convertFirst32to64(fTowerNum32) );
+  shower.ring = numEta >= 0 ? numEta : -numEta-1;
+  shower.energy = static_cast<float>(fEnergy/GeV);
+  shower.theta = static_cast<float>( fLocalDir.theta() );
+  shower.phi = static_cast<float>( fLocalDir.phi() );
+
+  for (G4int iColl = 0; iColl < hce->GetNumberOfCollections(); iColl++) {
+    auto* hits = dynamic_cast<DRcaloSiPMHitsCollection*>( hce->GetHC(iColl) );
+
+    if (!hits)
+      continue;
+
+    for (size_t iHit = 0; iHit < hits->GetSize(); iHit++) {
+      const DRcaloSiPMHit* hit = (*hits)[iHit];
+      auto global = pSeg->position( hit->GetSiPMnum() ); // DD4hep units
+      G4ThreeVector local = fToTower.TransformPoint( G4ThreeVector( global.x(), global.y(), global.z() )*CLHEP::millimeter/dd4hep::millimeter );
+
+      DRcaloShowerLibrary::SiPM sipm;
+      sipm.dx = static_cast<float>( ( local.x() - fLocalPos.x() )/mm );
+      sipm.dy = static_cast<float>( ( local.y() - fLocalPos.y() )/mm );
+
+      for (const auto& bin : hit->GetTimeStruct())
+        sipm.time.emplace_back( bin.first - static_cast<float>(fTime/ns), bin.second );
+
+      for (const auto& bin : hit->GetWavlenSpectrum())
+        sipm.wavlen.emplace_back( bin.first, bin.second );
+
+      shower.sipms.push_back( std::move(sipm) );
+    }
+  }
+
+  G4AutoLock lock(&libraryMutex);
+  pLibrary->add( std::move(shower) );
+}
+
+} // namespace drc
@@ -0,0 +1,266 @@
+#include "SimG4DRcaloStackingAction.h"
+
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTypes.hh"
+#include "G4VProcess.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4OpticalSurface.hh"
+#include "G4AutoLock.hh"
+#include "G4StackManager.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "globals.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+
+#include "DD4hep/Detector.h"
+#include "DD4hep/OpticalSurfaces.h"
+#include "DDG4/Geant4Mapping.h"
+
+namespace {
+  G4Mutex cacheMutex = G4MUTEX_INITIALIZER;
+
+  G4OpticalSurface* findSurface(const std::string& name) {
+    dd4hep::sim::Geant4GeometryInfo& info = dd4hep::sim::Geant4Mapping::instance().data();
+    dd4hep::OpticalSurface surfProp = dd4hep::Detector::getInstance().surfaceManager().opticalSurface(name);
+
+    if ( !surfProp.isValid() )
+      return nullptr;
+
+    auto surf = info.g4OpticalSurfaces.find(surfProp.access());
+
+    return surf==info.g4OpticalSurfaces.end() ? nullptr : surf->second;
+  }
+}
+
+namespace drc {
+
+std::unique_ptr<G4MaterialPropertyVector> SimG4DRcaloStackingAction::sTransmittance = nullptr;
+std::unique_ptr<G4MaterialPropertyVector> SimG4DRcaloStackingAction::sEfficiency = nullptr;
+std::atomic<bool> SimG4DRcaloStackingAction::sCached(false);
+
+SimG4DRcaloStackingAction::SimG4DRcaloStackingAction()
+: G4UserStackingAction(), fApplyFilter(true), fApplyPDE(true), fPhotonWeight(1), fFiberAcceptance(false), fSeed(0),
+  fMaxStacked(0), fMaxDeferred(0), fDropped(0), fHasSentinel(false), fReleasing(false), fReleaseClass(fUrgent), pKillPolicy(nullptr), pBenchmark(nullptr) {}
+
+SimG4DRcaloStackingAction::~SimG4DRcaloStackingAction() {}
+
+G4ClassificationOfNewTrack SimG4DRcaloStackingAction::ClassifyNewTrack(const G4Track* track) {
+  // deferred photons have passed the classification (and have been counted) before they were deferred
+  if (fReleasing)
+    return fReleaseClass;
+
+  if (pBenchmark)
+    pBenchmark->countNewTrack(track);
+
+  if ( pKillPolicy && pKillPolicy->killAtBirth(track) )
+    return fKill;
+
+  if ( track->GetDefinition() != G4OpticalPhoton::OpticalPhotonDefinition() )
+    return fUrgent;
+
+  // photons outside the trapping cone of the fiber never reach the SiPM
+  if ( fFiberAcceptance && !fAcceptance.isTrapped(track) )
+    return fKill;
+
+  if ( !fApplyFilter && !fApplyPDE && fPhotonWeight==1 )
+    return classifyAlive(track);
+
+  if ( !sCached )
+    cacheProperties(fApplyPDE);
+
+  // kill doomed photons before they are tracked,
+  // then keep 1 out of w photons, the weight w is given at their creation by SimG4DRcaloSteppingAction
+  if ( fRandom.flat() > survivalProb(track)/static_cast<double>(fPhotonWeight) )
+    return fKill;
+
+  return classifyAlive(track);
+}
+
+G4ClassificationOfNewTrack SimG4DRcaloStackingAction::classifyAlive(const G4Track* track) {
+  if ( fMaxStacked <= 0 || stackManager->GetNUrgentTrack() < fMaxStacked )
+    return fUrgent;
+
+  if (!fHasSentinel) {
+    fHasSentinel = true;
+
+    return fWaiting;
+  }
+
+  // the buffer holds about 90 bytes per photon, optionally bound the memory of an event at the cost of the signal
+  if ( fMaxDeferred > 0 && static_cast<long>( fDeferred.size() ) >= fMaxDeferred ) {
+    if ( fDropped++ == 0 ) {
+      const G4Event* event = G4EventManager::GetEventManager()->GetConstCurrentEvent();
+      G4ExceptionDescription msg;
+      msg << "Event " << ( event ? event->GetEventID() : -1 ) << " has more than " << fMaxDeferred
+          << " deferred optical photons (maxDeferredPhotons), the photons beyond are killed for the rest of the event";
+      G4Exception("SimG4DRcaloStackingAction::classifyAlive", "DRcalo0001", JustWarning, msg);
+    }
+
+    return fKill;
+  }
+
+  defer(track);
+
+  return fKill;
+}
+
+void SimG4DRcaloStackingAction::NewStage() {
+  // the sentinel is back in the urgent stack
+  fHasSentinel = false;
+
+  if ( fDeferred.empty() )
+    return;
+
+  // the last photon of the batch is the next sentinel if any photon is left
+  releaseBatch( std::min( fDeferred.size(), static_cast<size_t>(fMaxStacked) ), true );
+  fHasSentinel = !fDeferred.empty();
+}
+
+void SimG4DRcaloStackingAction::releaseDeferred() {
+  if ( fDeferred.empty() )
+    return;
+
+  // low-water mark, the urgent stack is topped up in batches of at least half of the bound
+  const int urgent = stackManager->GetNUrgentTrack();
+
+  if ( urgent > fMaxStacked/2 )
+    return;
+
+  releaseBatch( std::min( fDeferred.size(), static_cast<size_t>(fMaxStacked - urgent) ), false );
+}
+
+void SimG4DRcaloStackingAction::releaseBatch(const size_t num, const bool lastWaiting) {
+  // last in, first out
+  fReleasing = true;
+
+  for (size_t idx = 0; idx < num; idx++) {
+    fReleaseClass = ( lastWaiting && idx+1==num && fDeferred.size() > 1 ) ? fWaiting : fUrgent;
+    stackManager->PushOneTrack( release( fDeferred.back() ) );
+    fDeferred.pop_back();
+  }
+
+  fReleasing = false;
+}
+
+void SimG4DRcaloStackingAction::PrepareNewEvent() {
+  // the capacity is kept for the next event
+  fDeferred.clear();
+  fDropped = 0;
+  fHasSentinel = false;
+  fReleasing = false;
+
+  // the stream of the event is keyed by the seed, the run & event IDs and a draw of the engine of the event,
+  // which keeps the events apart even if the framework does not number them
+  const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+  const G4Event* event = G4EventManager::GetEventManager()->GetConstCurrentEvent();
+
+  std::uint64_t key = DRcaloRandom::key( fSeed, static_cast<std::uint64_t>( run ? run->GetRunID() : 0 ) );
+  key = DRcaloRandom::key( key, static_cast<std::uint64_t>( event ? event->GetEventID() : 0 ) );
+  key = DRcaloRandom::key( key, static_cast<std::uint64_t>( G4UniformRand()*9007199254740992. ) );
+
+  fRandom.reset(key,0);
+}
+
+void SimG4DRcaloStackingAction::defer(const G4Track* track) {
+  const G4ThreeVector& dir = track->GetMomentumDirection();
+  const G4ThreeVector& pol = track->GetPolarization();
+
+  DeferredPhoton photon;
+  photon.touchable = track->GetTouchableHandle();
+  photon.position = track->GetPosition();
+  photon.time = track->GetGlobalTime();
+  photon.direction[0] = static_cast<float>(dir.x());
+  photon.direction[1] = static_cast<float>(dir.y());
+  photon.direction[2] = static_cast<float>(dir.z());
+  photon.polarization[0] = static_cast<float>(pol.x());
+  photon.polarization[1] = static_cast<float>(pol.y());
+  photon.polarization[2] = static_cast<float>(pol.z());
+  photon.energy = static_cast<float>( track->GetKineticEnergy() );
+  photon.weight = static_cast<float>( track->GetWeight() );
+  photon.trackID = track->GetTrackID();
+  photon.parentID = track->GetParentID();
+  photon.creator = track->GetCreatorProcess();
+
+  fDeferred.push_back(photon);
+}
+
+G4Track* SimG4DRcaloStackingAction::release(const DeferredPhoton& photon) const {
+  G4ThreeVector dir( photon.direction[0], photon.direction[1], photon.direction[2] );
+
+  auto* particle = new G4DynamicParticle( G4OpticalPhoton::OpticalPhotonDefinition(), dir.unit(), static_cast<double>(photon.energy) );
+  particle->SetPolarization( G4ThreeVector( photon.polarization[0], photon.polarization[1], photon.polarization[2] ) );
+
+  // the touchable of birth is restored, as for a secondary pushed by its parent
+  auto* track = new G4Track( particle, photon.time, photon.position ); // deleted by G4
+  track->SetTouchableHandle(photon.touchable);
+  track->SetTrackID(photon.trackID);
+  track->SetParentID(photon.parentID);
+  track->SetCreatorProcess(photon.creator);
+  track->SetWeight(photon.weight);
+
+  return track;
+}
+
+double SimG4DRcaloStackingAction::survivalProb(const G4Track* track) const {
+  double photonMomentum = track->GetDynamicParticle()->GetTotalMomentum();
+  double prob = 1.;
+
+  // filter is only applied to the scintillation channel,
+  // i.e. every photon born in a scintillating material regardless of the process that created it
+  if ( fApplyFilter && sTransmittance ) {
+    auto* volume = track->GetVolume(); // touchable of the parent step, the G4Step of a new track is not set yet
+    auto* mpt = volume ? volume->GetLogicalVolume()->GetMaterial()->GetMaterialPropertiesTable() : nullptr;
+
+    if ( mpt && mpt->ConstPropertyExists(kSCINTILLATIONYIELD) )
+      prob *= sTransmittance->Value(photonMomentum);
+  }
+
+  if ( fApplyPDE && sEfficiency )
+    prob *= sEfficiency->Value(photonMomentum);
+
+  return prob;
+}
+
+void SimG4DRcaloStackingAction::cacheProperties(bool replacePDE) {
+  G4AutoLock lock(&cacheMutex);
+
+  if (sCached)
+    return;
+
+  G4OpticalSurface* filterSurf = findSurface("/world/DRcalo#FilterSurf");
+
+  if ( filterSurf && filterSurf->GetMaterialPropertiesTable() ) {
+    auto* transvec = filterSurf->GetMaterialPropertiesTable()->GetProperty(kTRANSMITTANCE);
+
+    if (transvec)
+      sTransmittance = std::make_unique<G4MaterialPropertyVector>(*transvec);
+  }
+
+  G4OpticalSurface* sipmSurf = findSurface("/world/DRcalo#SiPMSurf");
+
+  if ( replacePDE && sipmSurf && sipmSurf->GetMaterialPropertiesTable() ) {
+    auto* mpt = sipmSurf->GetMaterialPropertiesTable();
+    auto* effvec = mpt->GetProperty(kEFFICIENCY);
+
+    if (effvec) {
+      sEfficiency = std::make_unique<G4MaterialPropertyVector>(*effvec);
+
+      // PDE is already applied at birth, every photon reaching the SiPM is detected
+      std::vector<G4double> energies;
+      for (size_t idx = 0; idx < effvec->GetVectorLength(); idx++)
+        energies.push_back( effvec->Energy(idx) );
+
+      mpt->AddProperty("EFFICIENCY", energies, std::vector<G4double>(energies.size(),1.));
+    }
+  }
+
+  sCached = true;
+}
+
+} // namespace drc
@@ -3,55 +3,48 @@
 #include "G4ParticleDefinition.hh"
 #include "G4ParticleTypes.hh"
 #include "G4VProcess.hh"
+#include "G4NavigationHistory.hh"
+#include "G4SteppingManager.hh"
 
 #include "CLHEP/Units/SystemOfUnits.h"
 #include "DD4hep/DD4hepUnits.h"
 
-#include "DD4hep/Detector.h"
-#include "DD4hep/OpticalSurfaces.h"
-#include "DDG4/Geant4Mapping.h"
+#include <algorithm>
+#include <cmath>
 
 namespace drc {
 
 SimG4DRcaloSteppingAction::SimG4DRcaloSteppingAction()
-: G4UserSteppingAction(), fPrevTower(0), fPrevFiber(0), fPrevId(0) {
-  // get static methods
-  dd4hep::sim::Geant4GeometryInfo& info = dd4hep::sim::Geant4Mapping::instance().data();
-  dd4hep::Detector& description = dd4hep::Detector::getInstance();
-
-  dd4hep::OpticalSurfaceManager surfMgr = description.surfaceManager();
-  dd4hep::OpticalSurface filterSurfProp = surfMgr.opticalSurface("/world/DRcalo#FilterSurf");
-
-  if ( filterSurfProp.isValid() )
-    fFilterSurf = info.g4OpticalSurfaces[filterSurfProp.access()];
-}
+: G4UserSteppingAction(), fPrevTower(0), fVoxelSlice(0.), fVoxelXY(0.), fFiberEdeps(false), fFiberAcceptance(false), fPhotonFree(false), fPhotonWeight(1), pShowerRecorder(nullptr), pKillPolicy(nullptr), pBenchmark(nullptr), pProfiler(nullptr), pStackingAction(nullptr) {}
 
 SimG4DRcaloSteppingAction::~SimG4DRcaloSteppingAction() {}
 
 void SimG4DRcaloSteppingAction::UserSteppingAction(const G4Step* step) {
+  // profiled first, so the time spent in this action goes to the next step
+  if (pProfiler)
+    pProfiler->profile(step);
+
+  if ( fPhotonWeight > 1 )
+    weightSecondaries(step);
+
   G4Track* track = step->GetTrack();
   G4ParticleDefinition* particle = track->GetDefinition();
 
+  if (pBenchmark)
+    pBenchmark->countStep(track);
+
+  // the energy deposit of this step is still counted
+  if ( pKillPolicy && pKillPolicy->killInFlight(track) )
+    track->SetTrackStatus(G4TrackStatus::fStopAndKill);
+
+  if (pStackingAction)
+    pStackingAction->releaseDeferred();
+
+  // yellow filter & PDE are applied at birth by SimG4DRcaloStackingAction
   if ( particle == G4OpticalPhoton::OpticalPhotonDefinition() ) {
-    // apply yellow filter here to save CPU efficiency
-    // prevent double-counting filter efficiency
-    if ( fPrevId==track->GetTrackID() )
-      return;
-
-    auto* mpt = track->GetMaterial()->GetMaterialPropertiesTable();
-
-    // only applied to the scintillation channel
-    if ( mpt && mpt->ConstPropertyExists(kSCINTILLATIONYIELD) ) {
-      if ( fFilterSurf && fFilterSurf->GetMaterialPropertiesTable()->GetProperty(kTRANSMITTANCE) ) {
-        double photonMomentum = track->GetDynamicParticle()->GetTotalMomentum();
-        auto* transvec = fFilterSurf->GetMaterialPropertiesTable()->GetProperty(kTRANSMITTANCE);
-        double transmittance = transvec->Value(photonMomentum);
-        fPrevId = track->GetTrackID();
-
-        if ( G4UniformRand() > transmittance )
-          track->SetTrackStatus(G4TrackStatus::fStopAndKill);
-      }
-    }
+    // photons leaving the cladding are never trapped again
+    if ( fFiberAcceptance && fAcceptance.isEscaping(step) )
+      track->SetTrackStatus(G4TrackStatus::fStopAndKill);
 
     return;
   }
@@ -60,6 +53,9 @@ void SimG4DRcaloSteppingAction::UserSteppingAction(const G4Step* step) {
   G4StepPoint* poststeppoint = step->GetPostStepPoint();
   G4TouchableHandle theTouchable = presteppoint->GetTouchableHandle();
 
+  if (pShowerRecorder)
+    pShowerRecorder->recordEntry(step);
+
   // leakage particles
   if (poststeppoint->GetStepStatus() == fWorldBoundary) {
     saveLeakage(track,presteppoint);
@@ -75,7 +71,10 @@ void SimG4DRcaloSteppingAction::UserSteppingAction(const G4Step* step) {
   int towerNum32 = theTouchable->GetCopyNumber( theTouchable->GetHistoryDepth()-2 );
   auto towerNum64 = pSeg->convertFirst32to64( towerNum32 );
 
-  if (edep > m_thres) {
+  if ( fVoxelSlice > 0. ) {
+    if ( edep > 0. )
+      accumulateVoxel(theTouchable(), towerNum32, presteppoint->GetPosition(), edep);
+  } else if (edep > m_thres) {
     auto simEdep3d = m_Edeps3d->create();
     simEdep3d.setCellID( static_cast<unsigned long long>(towerNum64) );
     simEdep3d.setEnergy(edep);
@@ -86,56 +85,192 @@ void SimG4DRcaloSteppingAction::UserSteppingAction(const G4Step* step) {
                              static_cast<float>(pos.z()*CLHEP::millimeter) } );
   }
 
-  accumulate(fPrevTower,towerNum64,edep);
+  accumulate(towerNum64,edep);
+
+  if ( fFiberEdeps && edep > 0. )
+    accumulateFiber(theTouchable(), towerNum64, edep);
+
+  // photoelectrons of the charged steps in the fiber cores without optical photons
+  if (fPhotonFree)
+    fPhotonFreeConv.convert(step);
 
   return;
 }
 
-void SimG4DRcaloSteppingAction::accumulate(unsigned int &prev, dd4hep::DDSegmentation::CellID& id64, float edep) {
-  // search for the element
-  bool found = false;
-  edm4hep::MutableSimCalorimeterHit* thePtr = nullptr;
-
-  if ( m_Edeps->size() > prev ) { // check previous element
-    auto element = m_Edeps->at(prev);
-    if ( checkId(element, id64) ) {
-      thePtr = &element;
-      found = true;
-    }
+void SimG4DRcaloSteppingAction::setEdepsCollection(edm4hep::SimCalorimeterHitCollection* data) {
+  m_Edeps = data;
+
+  // new event
+  fTowerEdeps.clear();
+  fTowerIndex.clear();
+  fPrevTower = 0;
+  fVoxels.clear();
+  fVoxelIndex.clear();
+}
+
+void SimG4DRcaloSteppingAction::setFiberEdepsCollection(edm4hep::SimCalorimeterHitCollection* data) {
+  m_FiberEdeps = data;
+  fFiberArena.reset();
+}
+
+void SimG4DRcaloSteppingAction::accumulate(dd4hep::DDSegmentation::CellID id64, float edep) {
+  // consecutive steps are likely in the same tower
+  if ( fPrevTower < fTowerEdeps.size() && fTowerEdeps[fPrevTower].first==id64 ) {
+    fTowerEdeps[fPrevTower].second += edep;
+
+    return;
   }
 
-  if (!found) { // fall back to loop
-    for (unsigned int iElement = 0; iElement < m_Edeps->size(); iElement++) {
-      auto element = m_Edeps->at(iElement);
-      if ( checkId(element, id64) ) {
-        found = true;
-        prev = iElement;
-        thePtr = &element;
-
-        break;
-      }
-    }
+  auto found = fTowerIndex.find(id64);
+
+  if ( found==fTowerIndex.end() ) {
+    found = fTowerIndex.emplace(id64,fTowerEdeps.size()).first;
+    fTowerEdeps.emplace_back(id64,0.);
   }
 
-  if (!found) { // create
+  fPrevTower = found->second;
+  fTowerEdeps[fPrevTower].second += edep;
+}
+
+void SimG4DRcaloSteppingAction::flushEdeps() {
+  for (const auto& tower : fTowerEdeps) {
     auto simEdep = m_Edeps->create();
-    simEdep.setCellID( static_cast<unsigned long long>(id64) );
-    simEdep.setEnergy(0.); // added later
+    simEdep.setCellID( static_cast<unsigned long long>(tower.first) );
+    simEdep.setEnergy(tower.second);
+
+    // once per tower
+    auto pos = pSeg->position(tower.first);
+    simEdep.setPosition( { static_cast<float>(pos.x()*CLHEP::millimeter/dd4hep::millimeter),
+                           static_cast<float>(pos.y()*CLHEP::millimeter/dd4hep::millimeter),
+                           static_cast<float>(pos.z()*CLHEP::millimeter/dd4hep::millimeter) } );
+  }
+
+  fTowerEdeps.clear();
+  fTowerIndex.clear();
+  fPrevTower = 0;
+
+  // one hit per voxel at the energy-weighted position, the threshold applies to the voxel
+  for (const auto& voxel : fVoxels) {
+    if ( voxel.edep <= m_thres )
+      continue;
+
+    auto simEdep3d = m_Edeps3d->create();
+    simEdep3d.setCellID( static_cast<unsigned long long>(voxel.tower) );
+    simEdep3d.setEnergy( static_cast<float>(voxel.edep) );
+
+    G4ThreeVector pos = voxel.weightedPos/voxel.edep;
+    simEdep3d.setPosition( { static_cast<float>(pos.x()*CLHEP::millimeter),
+                             static_cast<float>(pos.y()*CLHEP::millimeter),
+                             static_cast<float>(pos.z()*CLHEP::millimeter) } );
+  }
+
+  fVoxels.clear();
+  fVoxelIndex.clear();
 
-    auto pos = pSeg->position(id64);
+  for (size_t idx = 0; idx < fFiberArena.size(); idx++) {
+    auto fiber = fFiberArena.fiber(idx);
+    auto simEdep = m_FiberEdeps->create();
+    simEdep.setCellID( static_cast<unsigned long long>(fiber.cellID) );
+    simEdep.setEnergy(fiber.edep);
+
+    auto pos = pSeg->position(fiber.cellID);
     simEdep.setPosition( { static_cast<float>(pos.x()*CLHEP::millimeter/dd4hep::millimeter),
                            static_cast<float>(pos.y()*CLHEP::millimeter/dd4hep::millimeter),
                            static_cast<float>(pos.z()*CLHEP::millimeter/dd4hep::millimeter) } );
-    prev = m_Edeps->size();
-    thePtr = &simEdep;
   }
+}
 
-  auto edepPrev = thePtr->getEnergy();
-  thePtr->setEnergy( edepPrev + edep );
+void SimG4DRcaloSteppingAction::accumulateFiber(const G4VTouchable* touchable, dd4hep::DDSegmentation::CellID towerNum64, float edep) {
+  const G4LogicalVolume* lv = touchable->GetVolume()->GetLogicalVolume();
+  auto core = fIsCore.find(lv);
+
+  if ( core==fIsCore.end() ) {
+    const G4String& name = lv->GetName();
+    core = fIsCore.emplace( lv, name.rfind("coreC",0)==0 || name.rfind("coreS",0)==0 ).first;
+  }
+
+  if ( !core->second )
+    return;
+
+  // the SiPM layer shares the x & y of the tower frame
+  const G4NavigationHistory* history = touchable->GetHistory();
+  const int towerLevel = 2;
+  G4ThreeVector global = history->GetTopTransform().InverseTransformPoint( G4ThreeVector(0.,0.,0.) );
+  G4ThreeVector local = history->GetTransform(towerLevel).TransformPoint( global );
+  dd4hep::Position loc(local.x()*dd4hep::millimeter/CLHEP::millimeter, local.y()*dd4hep::millimeter/CLHEP::millimeter, 0.);
+  dd4hep::Position glob(global.x()*dd4hep::millimeter/CLHEP::millimeter, global.y()*dd4hep::millimeter/CLHEP::millimeter, global.z()*dd4hep::millimeter/CLHEP::millimeter);
+
+  auto sipm = pSeg->cellID(loc, glob, towerNum64);
+
+  const int numEta = pSeg->numEta(towerNum64);
+  auto grid = fTowerGrid.find(numEta);
+
+  if ( grid==fTowerGrid.end() )
+    grid = fTowerGrid.emplace( numEta, std::make_pair( pSeg->numX(towerNum64), pSeg->numY(towerNum64) ) ).first;
+
+  fFiberArena.add(towerNum64, grid->second.first, grid->second.second, pSeg->x(sipm), pSeg->y(sipm), sipm, edep);
 }
 
-bool SimG4DRcaloSteppingAction::checkId(edm4hep::SimCalorimeterHit edep, dd4hep::DDSegmentation::CellID& id64) {
-  return ( edep.getCellID()==static_cast<unsigned long long>(id64) );
+void SimG4DRcaloSteppingAction::accumulateVoxel(const G4VTouchable* touchable, int towerNum32, const G4ThreeVector& pos, float edep) {
+  // world > assembly > tower, z of the tower frame runs from the inner face to the SiPMs
+  const int towerLevel = 2;
+  const G4ThreeVector local = touchable->GetHistory()->GetTransform(towerLevel).TransformPoint(pos);
+  const double halfZ = towerHalfZ(towerNum32);
+
+  const int nSlice = std::max( static_cast<int>( std::ceil( 2.*halfZ/fVoxelSlice ) ), 1 );
+  const int slice = std::clamp( static_cast<int>( std::floor( ( local.z() + halfZ )/fVoxelSlice ) ), 0, nSlice-1 );
+
+  // transverse grid centered at the tower axis, 8 bits each
+  int ix = 0;
+  int iy = 0;
+
+  if ( fVoxelXY > 0. ) {
+    ix = std::clamp( static_cast<int>( std::floor( local.x()/fVoxelXY ) ), -128, 127 );
+    iy = std::clamp( static_cast<int>( std::floor( local.y()/fVoxelXY ) ), -128, 127 );
+  }
+
+  const unsigned long long key = static_cast<unsigned long long>( static_cast<unsigned int>(towerNum32) )
+                               | ( static_cast<unsigned long long>( slice & 0xffff ) << 32 )
+                               | ( static_cast<unsigned long long>( ( ix + 128 ) & 0xff ) << 48 )
+                               | ( static_cast<unsigned long long>( ( iy + 128 ) & 0xff ) << 56 );
+
+  auto found = fVoxelIndex.find(key);
+
+  if ( found==fVoxelIndex.end() ) {
+    found = fVoxelIndex.emplace(key,fVoxels.size()).first;
+    fVoxels.emplace_back();
+    fVoxels.back().tower = pSeg->convertFirst32to64(towerNum32);
+  }
+
+  Voxel& voxel = fVoxels[found->second];
+  voxel.edep += edep;
+  voxel.weightedPos += static_cast<double>(edep)*pos;
+}
+
+double SimG4DRcaloSteppingAction::towerHalfZ(int towerNum32) {
+  const int numEta = pSeg->numEta(towerNum32);
+  auto found = fTowerHalfZ.find(numEta);
+
+  if ( found!=fTowerHalfZ.end() )
+    return found->second;
+
+  // DRparamBase is in the DD4hep units
+  double halfZ = pSeg->towerH(numEta)/2.*CLHEP::millimeter/dd4hep::millimeter;
+
+  return fTowerHalfZ.emplace(numEta,halfZ).first->second;
+}
+
+void SimG4DRcaloSteppingAction::weightSecondaries(const G4Step* step) {
+  // the secondaries of this step are the last ones of the stepping manager, not yet stacked
+  G4TrackVector* secondaries = fpSteppingManager->GetfSecondary();
+  const size_t num = step->GetNumberOfSecondariesInCurrentStep();
+
+  for (size_t idx = secondaries->size() - num; idx < secondaries->size(); idx++) {
+    G4Track* secondary = (*secondaries)[idx];
+
+    if ( secondary->GetDefinition() == G4OpticalPhoton::OpticalPhotonDefinition() )
+      secondary->SetWeight( secondary->GetWeight()*static_cast<double>(fPhotonWeight) );
+  }
 }
 
 void SimG4DRcaloSteppingAction::saveLeakage(G4Track* track, G4StepPoint* presteppoint) {
@@ -0,0 +1,94 @@
+#ifndef DRcaloRandom_h
+#define DRcaloRandom_h 1
+
+#include <cstddef>
+#include <cstdint>
+
+namespace drc {
+// Philox4x32-10 counter-based generator (Salmon et al., SC'11, as in Random123)
+// the n-th number of a stream is a pure function of (key, stream, n): a stream derived from e.g.
+// (seed, run, event) & a cell ID gives the same numbers whatever thread draws it & in whatever order the streams are drawn
+// a draw costs 10 rounds of two 32-bit multiplications per 4 numbers, with a state of a few words per stream
+class DRcaloRandom {
+public:
+  DRcaloRandom(std::uint64_t key = 0, std::uint64_t stream = 0) { reset(key,stream); }
+  ~DRcaloRandom() {}
+
+  void reset(std::uint64_t key, std::uint64_t stream) {
+    fKey[0] = static_cast<std::uint32_t>(key);
+    fKey[1] = static_cast<std::uint32_t>(key >> 32);
+    fCounter[0] = 0;
+    fCounter[1] = 0;
+    fCounter[2] = static_cast<std::uint32_t>(stream);
+    fCounter[3] = static_cast<std::uint32_t>(stream >> 32);
+    fIndex = 4;
+  }
+
+  std::uint32_t next() {
+    if ( fIndex==4 ) {
+      block(fCounter,fKey,fBuffer);
+      fIndex = 0;
+
+      // 64-bit block counter, the upper half of the counter is the stream
+      if ( ++fCounter[0]==0 )
+        ++fCounter[1];
+    }
+
+    return fBuffer[fIndex++];
+  }
+
+  // uniform in (0,1) with 53 bits
+  double flat() {
+    const std::uint64_t hi = next();
+    const std::uint64_t lo = next();
+
+    return ( static_cast<double>( ( (hi << 32) | lo ) >> 11 ) + 0.5 )*( 1./9007199254740992. );
+  }
+
+  void flatArray(std::size_t n, double* buffer) {
+    for (std::size_t idx = 0; idx < n; idx++)
+      buffer[idx] = flat();
+  }
+
+  // mixes two 64-bit words into a key (splitmix64 finalizer), e.g. key(key(seed,run),event)
+  static std::uint64_t key(std::uint64_t a, std::uint64_t b) {
+    std::uint64_t z = a + 0x9e3779b97f4a7c15ULL*( b + 1 );
+    z = ( z ^ (z >> 30) )*0xbf58476d1ce4e5b9ULL;
+    z = ( z ^ (z >> 27) )*0x94d049bb133111ebULL;
+
+    return z ^ (z >> 31);
+  }
+
+  // the Philox4x32-10 bijection of a counter under a key
+  static void block(const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4]) {
+    std::uint32_t ctr[4] = { counter[0], counter[1], counter[2], counter[3] };
+    std::uint32_t k0 = key[0];
+    std::uint32_t k1 = key[1];
+
+    for (int round = 0; round < 10; round++) {
+      const std::uint64_t prod0 = static_cast<std::uint64_t>(0xD2511F53U)*ctr[0];
+      const std::uint64_t prod1 = static_cast<std::uint64_t>(0xCD9E8D57U)*ctr[2];
+
+      const std::uint32_t next[4] = { static_cast<std::uint32_t>(prod1 >> 32) ^ ctr[1] ^ k0, static_cast<std::uint32_t>(prod1),
+                                      static_cast<std::uint32_t>(prod0 >> 32) ^ ctr[3] ^ k1, static_cast<std::uint32_t>(prod0) };
+
+      for (int idx = 0; idx < 4; idx++)
+        ctr[idx] = next[idx];
+
+      k0 += 0x9E3779B9U;
+      k1 += 0xBB67AE85U;
+    }
+
+    for (int idx = 0; idx < 4; idx++)
+      out[idx] = ctr[idx];
+  }
+
+private:
+  std::uint32_t fKey[2];
+  std::uint32_t fCounter[4];
+  std::uint32_t fBuffer[4];
+  int fIndex;
+};
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef DRcaloWaveform_h
+#define DRcaloWaveform_h 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace drc {
+// Conversion of uniformly binned data to & from edm4hep::SparseWaveform
+// the occupied bins are stored as runs (first bin & length) & their contents as int16 in units of the scale of the waveform,
+// the center of the bin i is start + (i + 0.5)*sampling
+// templated on the waveform so that it works with the mutable & const classes of any podio version
+namespace waveform {
+  // bin of the center of a bin
+  inline int bin(double center, double start, double sampling) {
+    return static_cast<int>( std::lround( (center - start)/sampling - 0.5 ) );
+  }
+
+  inline double center(int bin, double start, double sampling) {
+    return start + ( static_cast<double>(bin) + 0.5 )*sampling;
+  }
+
+  // fills an empty waveform from (bin, content) in increasing order of bins, the contents are rounded to multiples of precision
+  // (1 for counts) or coarser if the largest content would overflow int16, the bins rounded to 0 are dropped
+  template <class Waveform, class Bins>
+  void fill(Waveform& wf, double start, double sampling, double precision, const Bins& bins) {
+    const double maxQuantized = static_cast<double>( std::numeric_limits<std::int16_t>::max() );
+    double maxContent = 0.;
+
+    for (const auto& entry : bins)
+      maxContent = std::max( maxContent, std::abs( static_cast<double>(entry.second) ) );
+
+    const double scale = std::max( precision, maxContent/maxQuantized );
+
+    wf.setSampling( static_cast<float>(sampling) );
+    wf.setStart( static_cast<float>(start) );
+    wf.setScale( static_cast<float>(scale) );
+
+    int runStart = 0;
+    int runLength = 0;
+
+    for (const auto& entry : bins) {
+      const auto quantized = static_cast<short>( std::lround( static_cast<double>(entry.second)/scale ) );
+
+      if ( quantized==0 )
+        continue;
+
+      const int idx = static_cast<int>(entry.first);
+
+      if ( runLength > 0 && idx!=runStart + runLength ) {
+        wf.addToRunStarts(runStart);
+        wf.addToRunLengths(runLength);
+        runLength = 0;
+      }
+
+      if ( runLength==0 )
+        runStart = idx;
+
+      wf.addToContents(quantized);
+      runLength++;
+    }
+
+    if ( runLength > 0 ) {
+      wf.addToRunStarts(runStart);
+      wf.addToRunLengths(runLength);
+    }
+  }
+
+  // calls f(center, content) for every occupied bin in increasing order
+  template <class Waveform, class Function>
+  void forEachBin(const Waveform& wf, Function&& f) {
+    const double start = wf.getStart();
+    const double sampling = wf.getSampling();
+    const double scale = wf.getScale();
+    unsigned int iContent = 0;
+
+    for (unsigned int iRun = 0; iRun < wf.runStarts_size(); iRun++) {
+      const int first = wf.getRunStarts(iRun);
+      const int last = first + wf.getRunLengths(iRun);
+
+      for (int idx = first; idx < last; idx++, iContent++)
+        f( center(idx,start,sampling), scale*static_cast<double>( wf.getContents(iContent) ) );
+    }
+  }
+
+  // (center, content) of the occupied bins, e.g. to compare with the former edm4hep::SparseVector
+  template <class Waveform>
+  std::vector<std::pair<double, double>> bins(const Waveform& wf) {
+    std::vector<std::pair<double, double>> out;
+    out.reserve( wf.contents_size() );
+    forEachBin( wf, [&out](double cen, double con) { out.emplace_back(cen,con); } );
+
+    return out;
+  }
+}
+}
+
+#endif
@@ -68,6 +68,9 @@ namespace ddDRcalo {
     dd4hep::OpticalSurface* fMirrorSurf;
     dd4hep::DDSegmentation::GridDRcalo* fSegmentation;
 
+    std::string fAbsorberRegion; // empty if the towers stay in the world region
+    std::string fSipmRegion;
+
     bool fVis;
     int fNumx, fNumy;
     std::vector< std::pair<int,int> > fFiberCoords;
@@ -26,6 +26,13 @@ ddDRcalo::DRconstructor::DRconstructor(xml_det_t& x_det)
   fNumx = 0;
   fNumy = 0;
   fFiberCoords.reserve(100000);
+
+  // optional regions of the absorber & SiPMs, the fiber cores & claddings belong to the region of the detector
+  if ( x_det.hasAttr( _Unicode(absorberRegion) ) )
+    fAbsorberRegion = x_det.attr<std::string>( _Unicode(absorberRegion) );
+
+  if ( x_det.hasAttr( _Unicode(sipmRegion) ) )
+    fSipmRegion = x_det.attr<std::string>( _Unicode(sipmRegion) );
 }
 
 void ddDRcalo::DRconstructor::construct() {
@@ -59,6 +66,7 @@ void ddDRcalo::DRconstructor::implementTowers(xml_comp_t& x_theta, dd4hep::DDSeg
 
     dd4hep::Volume towerVol( "tower", tower, fDescription->material(x_theta.materialStr()) );
     towerVol.setVisAttributes(*fDescription, x_theta.visStr());
+    if (!fAbsorberRegion.empty()) towerVol.setRegion(*fDescription, fAbsorberRegion);
 
     implementFibers(x_theta, towerVol, tower, param, towerNo);
 
@@ -69,12 +77,14 @@ void ddDRcalo::DRconstructor::implementTowers(xml_comp_t& x_theta, dd4hep::DDSeg
                             param->GetH2(), param->GetBl2(), param->GetTl2(), 0. );
     dd4hep::Volume sipmLayerVol( "sipmLayer", sipmLayer, fDescription->material(fX_sipmDim.materialStr()) );
     if (fVis) sipmLayerVol.setVisAttributes(*fDescription, fX_sipmDim.visStr());
+    if (!fSipmRegion.empty()) sipmLayerVol.setRegion(*fDescription, fSipmRegion);
 
     // Photosensitive wafer
     dd4hep::Trap sipmWaferBox( x_wafer.height()/2., 0., 0., param->GetH2(), param->GetBl2(), param->GetTl2(), 0.,
                                param->GetH2(), param->GetBl2(), param->GetTl2(), 0. );
     dd4hep::Volume sipmWaferVol( "sipmWafer", sipmWaferBox, fDescription->material(x_wafer.materialStr()) );
     if (fVis) sipmWaferVol.setVisAttributes(*fDescription, x_wafer.visStr());
+    if (!fSipmRegion.empty()) sipmWaferVol.setRegion(*fDescription, fSipmRegion);
     dd4hep::SkinSurface(*fDescription, *fDetElement, "SiPMSurf_Tower"+std::to_string(towerNo), *fSipmSurf, sipmWaferVol);
 
     if (x_wafer.isSensitive()) {
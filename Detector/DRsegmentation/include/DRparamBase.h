@@ -26,6 +26,8 @@ namespace DDSegmentation {
     double GetCurrentInnerR() { return fCurrentInnerR; }
     double GetTowerH() { return fTowerH; }
     double GetSipmHeight() { return fSipmHeight; }
+    double GetPhiZRot() { return fPhiZRot; }
+    TVector3 GetCurrentCenter() { return fCurrentCenter; }
     double GetH1() { return fCurrentInnerHalf; }
     double GetBl1() { return fV3.X()*std::tan(fPhiZRot/2.); }
     double GetTl1() { return fV1.X()*std::tan(fPhiZRot/2.); }
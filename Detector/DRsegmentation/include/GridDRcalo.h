@@ -6,6 +6,9 @@
 
 #include "DDSegmentation/Segmentation.h"
 
+#include <mutex>
+#include <vector>
+
 namespace dd4hep {
 namespace DDSegmentation {
 class GridDRcalo : public Segmentation {
@@ -86,7 +89,11 @@ public:
   DRparamBarrel* paramBarrel() { return fParamBarrel; }
   DRparamEndcap* paramEndcap() { return fParamEndcap; }
 
-  DRparamBase* setParamBase(int noEta) const;
+  // geometry of the tower noEta, read from tables built at the first call after the geometry is finalized (thread-safe)
+  double towerH(int noEta) const; // full height
+  dd4hep::Position towerPos(int noEta, int noPhi) const;
+  dd4hep::Position sipmLayerPos(int noEta, int noPhi) const;
+  int unsignedTowerNo(int noEta) const { return noEta >= 0 ? noEta : -noEta-1; }
 
 protected:
   std::string fNumEtaId;
@@ -100,8 +107,29 @@ protected:
   double fSipmSize;
 
 private:
+  // immutable geometry of a tower, the phi dependence is computed as in DRparamBase
+  struct TowerGeom {
+    double phiZRot;
+    dd4hep::RotationZYX rotation; // at numPhi = 0
+    double centerX;
+    double centerZ; // signed
+    double centerMag;
+    double sipmLayerR; // distance of the SiPM layer center from the origin along the tower axis
+    double towerH;
+    int numX;
+    int numY;
+  };
+
+  const TowerGeom& tower(int noEta) const;
+  // points the barrel & endcap parameters to every tower in turn, called once
+  void buildTowers() const;
+
   DRparamBarrel* fParamBarrel;
   DRparamEndcap* fParamEndcap;
+
+  mutable std::once_flag fTowersOnce;
+  mutable std::vector<TowerGeom> fTowers; // indexed by noEta + number of towers of a side
+  mutable int fTowersOffset;
 };
 }
 }
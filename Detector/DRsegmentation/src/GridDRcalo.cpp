@@ -3,6 +3,7 @@
 #include <climits>
 #include <cmath>
 #include <stdexcept>
+#include <utility>
 
 namespace dd4hep {
 namespace DDSegmentation {
@@ -23,6 +24,7 @@ GridDRcalo::GridDRcalo(const std::string& cellEncoding) : Segmentation(cellEncod
 
   fParamBarrel = new DRparamBarrel();
   fParamEndcap = new DRparamEndcap();
+  fTowersOffset = 0;
 }
 
 GridDRcalo::GridDRcalo(const BitFieldCoder* decoder) : Segmentation(decoder) {
@@ -40,6 +42,7 @@ GridDRcalo::GridDRcalo(const BitFieldCoder* decoder) : Segmentation(decoder) {
 
   fParamBarrel = new DRparamBarrel();
   fParamEndcap = new DRparamEndcap();
+  fTowersOffset = 0;
 }
 
 GridDRcalo::~GridDRcalo() {
@@ -51,9 +54,9 @@ Vector3D GridDRcalo::position(const CellID& cID) const {
   int noEta = numEta(cID);
   int noPhi = numPhi(cID);
 
-  DRparamBase* paramBase = setParamBase(noEta);
-
-  auto transformA = paramBase->GetSipmTransform3D(noPhi);
+  const TowerGeom& geom = tower(noEta);
+  dd4hep::RotationZYX rotA = ROOT::Math::RotationZ( static_cast<double>(noPhi)*geom.phiZRot )*geom.rotation;
+  auto transformA = dd4hep::Transform3D( rotA, sipmLayerPos(noEta,noPhi) );
   dd4hep::Position localPos = dd4hep::Position(0.,0.,0.);
   if ( IsSiPM(cID) ) localPos = dd4hep::Position( localPosition(cID) );
 
@@ -143,23 +146,11 @@ int GridDRcalo::numPhi(const CellID& aCellID) const {
 
 // Get the total number of SiPMs of the mother tower in x or y direction (local coordinate)
 int GridDRcalo::numX(const CellID& aCellID) const {
-  int noEta = numEta(aCellID);
-
-  DRparamBase* paramBase = setParamBase(noEta);
-
-  int noX = static_cast<int>( std::floor( ( paramBase->GetTl2()*2. - fSipmSize )/fGridSize ) ) + 1; // in phi direction
-
-  return noX;
+  return tower( numEta(aCellID) ).numX; // in phi direction
 }
 
 int GridDRcalo::numY(const CellID& aCellID) const {
-  int noEta = numEta(aCellID);
-
-  DRparamBase* paramBase = setParamBase(noEta);
-
-  int noY = static_cast<int>( std::floor( ( paramBase->GetH2()*2. - fSipmSize )/fGridSize ) ) + 1; // in eta direction
-
-  return noY;
+  return tower( numEta(aCellID) ).numY; // in eta direction
 }
 
 // Get the identifier number of a SiPM in x or y direction (local coordinate)
@@ -208,24 +199,70 @@ CellID GridDRcalo::convertLast32to64(const int aId32) const {
   return aId64;
 }
 
-DRparamBase* GridDRcalo::setParamBase(int noEta) const {
-  DRparamBase* paramBase = nullptr;
+double GridDRcalo::towerH(int noEta) const {
+  return tower(noEta).towerH;
+}
 
-  if ( fParamEndcap->unsignedTowerNo(noEta) >= fParamBarrel->GetTotTowerNum() ) paramBase = static_cast<DRparamBase*>(fParamEndcap);
-  else paramBase = static_cast<DRparamBase*>(fParamBarrel);
+dd4hep::Position GridDRcalo::towerPos(int noEta, int noPhi) const {
+  const TowerGeom& geom = tower(noEta);
+  double phi = static_cast<double>(noPhi)*geom.phiZRot;
 
-  if ( paramBase->GetCurrentTowerNum()==noEta ) return paramBase;
+  return dd4hep::Position( std::cos(phi)*geom.centerX, std::sin(phi)*geom.centerX, geom.centerZ );
+}
 
-  // This should not be called while building detector geometry
-  if (!paramBase->IsFinalized()) throw std::runtime_error("GridDRcalo::position should not be called while building detector geometry!");
+dd4hep::Position GridDRcalo::sipmLayerPos(int noEta, int noPhi) const {
+  const TowerGeom& geom = tower(noEta);
+  double phi = static_cast<double>(noPhi)*geom.phiZRot;
+
+  return dd4hep::Position( std::cos(phi)*geom.centerX*geom.sipmLayerR/geom.centerMag,
+                           std::sin(phi)*geom.centerX*geom.sipmLayerR/geom.centerMag,
+                           geom.centerZ*geom.sipmLayerR/geom.centerMag );
+}
 
-  paramBase->SetDeltaThetaByTowerNo(noEta, fParamBarrel->GetTotTowerNum());
-  paramBase->SetThetaOfCenterByTowerNo(noEta, fParamBarrel->GetTotTowerNum());
-  paramBase->SetIsRHSByTowerNo(noEta);
-  paramBase->SetCurrentTowerNum(noEta);
-  paramBase->init();
+const GridDRcalo::TowerGeom& GridDRcalo::tower(int noEta) const {
+  // a failed build (e.g. called while building detector geometry) is retried at the next call
+  std::call_once( fTowersOnce, [this]() { buildTowers(); } );
 
-  return paramBase;
+  return fTowers.at( static_cast<size_t>( noEta + fTowersOffset ) );
+}
+
+void GridDRcalo::buildTowers() const {
+  // This should not be called while building detector geometry
+  if ( !fParamBarrel->IsFinalized() || !fParamEndcap->IsFinalized() )
+    throw std::runtime_error("GridDRcalo::position should not be called while building detector geometry!");
+
+  const int numBarrel = fParamBarrel->GetTotTowerNum();
+  const int numSide = numBarrel + fParamEndcap->GetTotTowerNum();
+  std::vector<TowerGeom> towers( static_cast<size_t>(2*numSide) );
+
+  for (int noEta = -numSide; noEta < numSide; noEta++) {
+    DRparamBase* paramBase = nullptr;
+
+    if ( unsignedTowerNo(noEta) >= numBarrel ) paramBase = static_cast<DRparamBase*>(fParamEndcap);
+    else paramBase = static_cast<DRparamBase*>(fParamBarrel);
+
+    paramBase->SetDeltaThetaByTowerNo(noEta, numBarrel);
+    paramBase->SetThetaOfCenterByTowerNo(noEta, numBarrel);
+    paramBase->SetIsRHSByTowerNo(noEta);
+    paramBase->SetCurrentTowerNum(noEta);
+    paramBase->init();
+
+    TVector3 center = paramBase->GetCurrentCenter();
+
+    TowerGeom& geom = towers.at( static_cast<size_t>(noEta + numSide) );
+    geom.phiZRot = paramBase->GetPhiZRot();
+    geom.rotation = paramBase->GetRotationZYX(0);
+    geom.centerX = center.X();
+    geom.centerZ = paramBase->GetIsRHS() ? center.Z() : -center.Z();
+    geom.centerMag = center.Mag();
+    geom.sipmLayerR = center.Mag() + paramBase->GetTowerH()/2. + paramBase->GetSipmHeight()/2.;
+    geom.towerH = paramBase->GetTowerH();
+    geom.numX = static_cast<int>( std::floor( ( paramBase->GetTl2()*2. - fSipmSize )/fGridSize ) ) + 1;
+    geom.numY = static_cast<int>( std::floor( ( paramBase->GetH2()*2. - fSipmSize )/fGridSize ) ) + 1;
+  }
+
+  fTowers = std::move(towers);
+  fTowersOffset = numSide;
 }
 
 }
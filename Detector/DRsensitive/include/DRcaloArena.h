@@ -0,0 +1,68 @@
+#ifndef DRcaloArena_h
+#define DRcaloArena_h 1
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace drc {
+// Allocation statistics of the hit payloads, summed over the events
+struct DRcaloArenaStats {
+  long events = 0;
+  long allocations = 0;
+  long bytesRequested = 0;
+  long bytesReserved = 0; // chunk bytes taken by the events (malloc chunks on the heap), the rest is fragmentation
+  long peakEventBytes = 0; // largest live reservation of a single event
+  long chunks = 0; // chunks taken from the heap
+  double allocatorTime = 0.; // s spent in allocate & deallocate, estimated from 1 call out of kTimeSampling
+
+  DRcaloArenaStats& operator+=(const DRcaloArenaStats& other);
+};
+
+// Per-thread, per-event arena of the SiPM hit payloads (time structure, wavelength spectrum & photon record)
+// the payloads are carved from chunks growing geometrically & released in bulk at the next event,
+// the chunks are kept for the following events so that a steady job stops calling the heap after its largest event
+// with bulk = false every allocation goes to the heap & is freed piecemeal as before, with the same statistics
+class DRcaloArena : public std::pmr::memory_resource {
+public:
+  DRcaloArena(bool bulk = true, std::size_t chunkSize = 1 << 16);
+  ~DRcaloArena();
+
+  DRcaloArena(const DRcaloArena&) = delete;
+  DRcaloArena& operator=(const DRcaloArena&) = delete;
+
+  // frees everything allocated since the last release & starts a new event, the payloads must be gone
+  void release();
+
+  bool isBulk() const { return fBulk; }
+
+  // statistics of the arenas of the calling thread are added to stats as they happen (nullptr to stop),
+  // so that the heap frees of an event are counted even if its hits outlive the end of the event
+  static void setStats(DRcaloArenaStats* stats);
+
+  static const unsigned kTimeSampling = 64;
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this==&other; }
+
+  void reserve(long bytes);
+
+  struct Chunk {
+    std::byte* data;
+    std::size_t size;
+  };
+
+  bool fBulk;
+  std::size_t fChunkSize;
+  std::vector<Chunk> fChunks;
+  std::size_t fCurrent; // chunk being carved
+  std::size_t fOffset;
+
+  long fLiveBytes; // reserved by the current event (bulk) or not yet freed (heap)
+  unsigned fCalls; // allocate & deallocate, for the sampling of the time
+};
+}
+
+#endif
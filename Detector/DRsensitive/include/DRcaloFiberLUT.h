@@ -0,0 +1,61 @@
+#ifndef DRcaloFiberLUT_h
+#define DRcaloFiberLUT_h 1
+
+#include <string>
+#include <vector>
+
+namespace drc {
+  // Response of a fiber to an optical photon born in its core
+  // indexed by the fiber type, unfolded distance to the SiPM, cosine of the angle to the fiber axis and wavelength
+  // the unfolded distance of a photon heading to the far end includes the way back from the end
+  // units are mm, ns and nm
+  class DRcaloFiberLUT {
+  public:
+    struct Response {
+      double survival = 0.;
+      double meanTime = 0.;
+      double rmsTime = 0.;
+    };
+
+    DRcaloFiberLUT(int distBin = 120, double distMax = 6000., int cosBin = 40, int wavBin = 30, double wavMin = 300., double wavMax = 900.);
+    ~DRcaloFiberLUT() {}
+
+    static const int kVersion = 1;
+
+    // return false if the file is missing or its version or format does not match
+    bool read(const std::string& filename);
+    bool write(const std::string& filename) const;
+
+    void fill(bool isCerenkov, double dist, double cosTheta, double wavlen, bool arrived, double time, double weight = 1.);
+
+    // table of the same binning without entries, e.g. filled by a single thread
+    DRcaloFiberLUT emptyCopy() const { return DRcaloFiberLUT(fDistBin,fDistMax,fCosBin,fWavBin,fWavMin,fWavMax); }
+    // add the entries of a table, return false if the binning does not match
+    bool add(const DRcaloFiberLUT& other);
+
+    Response response(bool isCerenkov, double dist, double cosTheta, double wavlen) const;
+
+    double unfoldedDistance(double localZ, double halfZ, double cosTheta) const {
+      return cosTheta > 0. ? halfZ - localZ : 3.*halfZ + localZ;
+    }
+
+  private:
+    int index(bool isCerenkov, double dist, double cosTheta, double wavlen) const;
+    int bin(double val, double min, double max, int nbin) const;
+    void resize();
+
+    int fDistBin;
+    double fDistMax;
+    int fCosBin;
+    int fWavBin;
+    double fWavMin;
+    double fWavMax;
+
+    std::vector<double> fBorn;
+    std::vector<double> fArrived;
+    std::vector<double> fTimeSum;
+    std::vector<double> fTime2Sum;
+  };
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef DRcaloShowerLibrary_h
+#define DRcaloShowerLibrary_h 1
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace drc {
+  // Frozen electromagnetic showers recorded by the full simulation
+  // a shower is the photoelectrons of the SiPMs in the frame of the tower hit by the incident particle:
+  // dx & dy from the entry point (perpendicular to the tower axis), time from the entry time
+  // showers are binned by the eta ring (unsigned tower number), log of the energy and angle to the tower axis
+  // units are mm, ns, nm and GeV
+  class DRcaloShowerLibrary {
+  public:
+    typedef std::vector<std::pair<float, int>> Histogram; // (bin center, count)
+
+    struct SiPM {
+      float dx = 0.;
+      float dy = 0.;
+      Histogram time;
+      Histogram wavlen;
+    };
+
+    struct Shower {
+      int ring = 0;
+      float energy = 0.;
+      float theta = 0.; // angle to the tower axis
+      float phi = 0.; // azimuth around the tower axis
+      std::vector<SiPM> sipms;
+    };
+
+    DRcaloShowerLibrary(double eMin = 1., double eMax = 100., int eBin = 10, double thetaMax = 0.1, int thetaBin = 4);
+    ~DRcaloShowerLibrary() {}
+
+    static const int kVersion = 1;
+
+    // return false if the file is missing or its version or format does not match
+    bool read(const std::string& filename);
+    bool write(const std::string& filename) const;
+
+    void add(Shower&& shower);
+
+    // a shower of the bin of (ring, energy, theta) picked by rand in [0,1),
+    // falls back to the closest energy bin and then to the closest ring, nullptr if the library is empty
+    const Shower* find(int ring, double energy, double theta, double rand) const;
+
+    size_t size() const;
+
+  private:
+    typedef std::pair<int, int> Key; // (energy bin, theta bin)
+
+    int energyBin(double energy) const;
+    int thetaBin(double theta) const;
+    const std::vector<Shower>* closestEnergy(const std::map<Key, std::vector<Shower>>& ring, int eIdx, int thetaIdx) const;
+
+    double fEmin;
+    double fEmax;
+    int fEbin;
+    double fThetaMax;
+    int fThetaBin;
+
+    std::map<int, std::map<Key, std::vector<Shower>>> fShowers; // by ring
+  };
+}
+
+#endif
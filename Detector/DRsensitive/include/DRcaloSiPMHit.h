@@ -9,13 +9,22 @@
 #include "DD4hep/Objects.h"
 #include "DD4hep/Segmentations.h"
 
+#include "DRcaloArena.h"
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
 namespace drc {
   class DRcaloSiPMHit : public G4VHit {
   public:
-    typedef std::map<float, int> DRsimTimeStruct;
-    typedef std::map<float, int> DRsimWavlenSpectrum;
+    typedef std::pmr::map<float, int> DRsimTimeStruct;
+    typedef std::pmr::map<float, int> DRsimWavlenSpectrum;
+    typedef std::pmr::vector<std::tuple<float, float, int>> DRsimPhotonRecord; // (arrival time in ns, wavelength in nm, weight)
 
-    DRcaloSiPMHit(float wavSampling, float timeSampling);
+    // the payloads are allocated from the arena of the event (the heap if null), which lives as long as its hits
+    DRcaloSiPMHit(float wavSampling, float timeSampling, std::shared_ptr<DRcaloArena> arena = nullptr);
     DRcaloSiPMHit(const DRcaloSiPMHit &right);
     virtual ~DRcaloSiPMHit();
 
@@ -28,26 +37,31 @@ namespace drc {
     virtual void Draw() {};
     virtual void Print() {};
 
-    void photonCount() { fPhotons++; }
+    void photonCount(unsigned long weight = 1) { fPhotons += weight; }
     unsigned long GetPhotonCount() const { return fPhotons; }
 
     void SetSiPMnum(dd4hep::DDSegmentation::CellID n) { fSiPMnum = n; }
     const dd4hep::DDSegmentation::CellID& GetSiPMnum() const { return fSiPMnum; }
 
-    void CountWavlenSpectrum(float center);
+    void CountWavlenSpectrum(float center, int weight = 1);
     const DRsimWavlenSpectrum& GetWavlenSpectrum() const { return fWavlenSpectrum; }
 
-    void CountTimeStruct(float center);
+    void CountTimeStruct(float center, int weight = 1);
     const DRsimTimeStruct& GetTimeStruct() const { return fTimeStruct; }
 
+    void RecordPhoton(float time, float wavlen, int weight = 1) { fPhotonRecord.emplace_back(time,wavlen,weight); }
+    const DRsimPhotonRecord& GetPhotonRecord() const { return fPhotonRecord; }
+
     float GetSamplingTime() { return mTimeSampling; }
     float GetSamplingWavlen() { return mWavSampling; }
 
   private:
+    std::shared_ptr<DRcaloArena> fArena; // destroyed after the payloads
     dd4hep::DDSegmentation::CellID fSiPMnum;
     unsigned long fPhotons;
     DRsimWavlenSpectrum fWavlenSpectrum;
     DRsimTimeStruct fTimeStruct;
+    DRsimPhotonRecord fPhotonRecord;
     float mWavSampling;
     float mTimeSampling;
   };
@@ -10,6 +10,13 @@
 #include "G4PhysicalConstants.hh"
 #include "G4Step.hh"
 #include "G4TouchableHistory.hh"
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace drc {
   class DRcaloSiPMSD : public G4VSensitiveDetector {
@@ -19,9 +26,41 @@ namespace drc {
 
     virtual void Initialize(G4HCofThisEvent* HCE) final;
     virtual bool ProcessHits(G4Step* aStep, G4TouchableHistory*) final;
+    virtual void EndOfEvent(G4HCofThisEvent* HCE) final;
+
+    // keep the exact arrival time & wavelength of each photon on top of the histograms
+    void setRecordPhotons(bool record) { fRecordPhotons = record; }
+    // same as above for the SDs named sdName of every thread, including the ones constructed later by the workers
+    static void recordPhotonsOf(const std::string& sdName);
+
+    // allocate the hit payloads of the SDs named sdName one by one on the heap instead of the arena of the event
+    static void heapPayloadsOf(const std::string& sdName);
+
+    // the optical photons are killed at birth with the filter transmittance or the PDE (SimG4DRcaloStackingAction),
+    // i.e. the photons reaching the SiPMs are already filtered & detected
+    static void setFilteredAtBirth(bool filtered);
+    static bool filteredAtBirth();
+
+    // count a photon arriving at the SiPM cID without tracking it to the SiPM (fast simulation)
+    void addPhoton(dd4hep::DDSegmentation::CellID cID, G4double time, G4double energy, G4int weight = 1);
+
+    // same as above for n photons of the same SiPM
+    void addPhotons(dd4hep::DDSegmentation::CellID cID, size_t n, const G4double* times, const G4double* energies, const G4int* weights);
+
+    // called at the end of every event before the hits are saved, e.g. to flush photons buffered by a fast simulation model
+    void addEndOfEventHook(std::function<void()> hook) { fEndOfEventHooks.push_back(hook); }
+
+    // SiPM attached to the fiber, the touchable must be inside the fiber (world > assembly > tower > ... > fiber)
+    dd4hep::DDSegmentation::CellID fiberCellID(const G4VTouchable* touchable) const;
+
+    // SiPM of the tower in the history (world > assembly > tower > ...) facing the global point
+    dd4hep::DDSegmentation::CellID sipmCellID(const G4NavigationHistory* history, const G4ThreeVector& global) const;
+
+    const dd4hep::DDSegmentation::GridDRcalo* segmentation() const { return fSeg; }
 
   private:
     DRcaloSiPMHitsCollection* fHitCollection;
+    std::unordered_map<dd4hep::DDSegmentation::CellID, DRcaloSiPMHit*> fHitIndex; // hits of the event by SiPM
     dd4hep::DDSegmentation::GridDRcalo* fSeg;
     G4int fHCID;
 
@@ -34,8 +73,19 @@ namespace drc {
     G4float fWavlenStep;
     G4float fTimeStep;
 
+    G4bool fRecordPhotons;
+    G4bool fBulkPayloads;
+    std::shared_ptr<DRcaloArena> fArena; // shared with the hits of the event
+
+    std::vector<std::function<void()>> fEndOfEventHooks;
+
+    DRcaloSiPMHit* findHit(dd4hep::DDSegmentation::CellID cID);
+    void countPhoton(DRcaloSiPMHit* hit, G4double time, G4double energy, G4int weight);
+
     G4double wavToE(G4double wav) { return h_Planck*c_light/wav; }
+    G4double eToWav(G4double en) { return h_Planck*c_light/en; }
 
+    // the bins are computed arithmetically & corrected by the comparison with their edges
     float findWavCenter(G4double en);
     float findTimeCenter(G4double stepTime);
   };
@@ -0,0 +1,153 @@
+#include "DRcaloArena.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <new>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+  thread_local drc::DRcaloArenaStats* tStats = nullptr;
+
+  // times 1 call out of kTimeSampling & counts it for all of them, two clock reads cost more than a bump allocation
+  class SampledTimer {
+  public:
+    SampledTimer(unsigned& calls) : fActive( tStats && ( calls++ % drc::DRcaloArena::kTimeSampling )==0 ) {
+      if (fActive)
+        fStart = std::chrono::steady_clock::now();
+    }
+
+    ~SampledTimer() {
+      if ( fActive && tStats )
+        tStats->allocatorTime += static_cast<double>(drc::DRcaloArena::kTimeSampling)*std::chrono::duration<double>( std::chrono::steady_clock::now() - fStart ).count();
+    }
+
+  private:
+    bool fActive;
+    std::chrono::steady_clock::time_point fStart;
+  };
+
+  // bytes taken from the heap by a malloc'ed block, its header included
+  long heapBytes(void* ptr, std::size_t bytes) {
+#ifdef __GLIBC__
+    return static_cast<long>( malloc_usable_size(ptr) + sizeof(std::size_t) );
+#else
+    (void)ptr;
+    return static_cast<long>(bytes);
+#endif
+  }
+}
+
+drc::DRcaloArenaStats& drc::DRcaloArenaStats::operator+=(const drc::DRcaloArenaStats& other) {
+  events += other.events;
+  allocations += other.allocations;
+  bytesRequested += other.bytesRequested;
+  bytesReserved += other.bytesReserved;
+  peakEventBytes = std::max(peakEventBytes, other.peakEventBytes);
+  chunks += other.chunks;
+  allocatorTime += other.allocatorTime;
+
+  return *this;
+}
+
+void drc::DRcaloArena::setStats(drc::DRcaloArenaStats* stats) {
+  tStats = stats;
+}
+
+drc::DRcaloArena::DRcaloArena(bool bulk, std::size_t chunkSize)
+: fBulk(bulk), fChunkSize( std::max<std::size_t>(chunkSize,256) ), fCurrent(0), fOffset(0), fLiveBytes(0), fCalls(0) {
+  if (tStats)
+    tStats->events++;
+}
+
+drc::DRcaloArena::~DRcaloArena() {
+  for (auto& chunk : fChunks)
+    ::operator delete(chunk.data);
+}
+
+void drc::DRcaloArena::release() {
+  if (tStats)
+    tStats->events++;
+
+  // the payloads of the previous event are freed piecemeal on the heap, what they took is already given back
+  if (!fBulk)
+    return;
+
+  fCurrent = 0;
+  fOffset = 0;
+  fLiveBytes = 0;
+}
+
+void drc::DRcaloArena::reserve(long bytes) {
+  fLiveBytes += bytes;
+
+  if (!tStats)
+    return;
+
+  tStats->bytesReserved += bytes;
+  tStats->peakEventBytes = std::max(tStats->peakEventBytes, fLiveBytes);
+}
+
+void* drc::DRcaloArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  SampledTimer timer(fCalls);
+
+  if (tStats) {
+    tStats->allocations++;
+    tStats->bytesRequested += static_cast<long>(bytes);
+  }
+
+  if (!fBulk) {
+    void* ptr = ::operator new( bytes, std::align_val_t(alignment) );
+    reserve( heapBytes(ptr,bytes) );
+
+    return ptr;
+  }
+
+  void* ptr = nullptr;
+
+  while (!ptr) {
+    if ( fCurrent < fChunks.size() ) {
+      Chunk& chunk = fChunks[fCurrent];
+      std::size_t space = chunk.size - fOffset;
+      void* candidate = chunk.data + fOffset;
+
+      if ( std::align(alignment, bytes, candidate, space) ) {
+        if ( fOffset==0 )
+          reserve( static_cast<long>(chunk.size) );
+
+        ptr = candidate;
+        fOffset = chunk.size - space + bytes;
+
+        break;
+      }
+
+      // the tail of the chunk is left unused for the event
+      fCurrent++;
+      fOffset = 0;
+
+      continue;
+    }
+
+    // twice the last chunk & large enough for the request
+    const std::size_t size = std::max( fChunks.empty() ? fChunkSize : 2*fChunks.back().size, bytes + alignment );
+    fChunks.push_back( Chunk{ static_cast<std::byte*>( ::operator new(size) ), size } );
+
+    if (tStats)
+      tStats->chunks++;
+  }
+
+  return ptr;
+}
+
+void drc::DRcaloArena::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) {
+  // freed in bulk by release
+  if (fBulk)
+    return;
+
+  SampledTimer timer(fCalls);
+  fLiveBytes -= heapBytes(ptr,bytes);
+  ::operator delete( ptr, bytes, std::align_val_t(alignment) );
+}
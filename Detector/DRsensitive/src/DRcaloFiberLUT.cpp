@@ -0,0 +1,120 @@
+#include "DRcaloFiberLUT.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+drc::DRcaloFiberLUT::DRcaloFiberLUT(int distBin, double distMax, int cosBin, int wavBin, double wavMin, double wavMax)
+: fDistBin(distBin), fDistMax(distMax), fCosBin(cosBin), fWavBin(wavBin), fWavMin(wavMin), fWavMax(wavMax) {
+  resize();
+}
+
+void drc::DRcaloFiberLUT::resize() {
+  size_t size = 2*static_cast<size_t>(fDistBin)*static_cast<size_t>(fCosBin)*static_cast<size_t>(fWavBin);
+
+  fBorn.assign(size,0.);
+  fArrived.assign(size,0.);
+  fTimeSum.assign(size,0.);
+  fTime2Sum.assign(size,0.);
+}
+
+bool drc::DRcaloFiberLUT::read(const std::string& filename) {
+  std::ifstream input(filename);
+
+  if (!input.is_open())
+    return false;
+
+  std::string header;
+  int version = 0;
+  input >> header >> version;
+
+  if ( header!="DRcaloFiberLUT" || version!=kVersion )
+    return false;
+
+  input >> fDistBin >> fDistMax >> fCosBin >> fWavBin >> fWavMin >> fWavMax;
+
+  if ( !input || fDistBin < 1 || fCosBin < 1 || fWavBin < 1 || fDistMax <= 0. || fWavMax <= fWavMin )
+    return false;
+
+  resize();
+
+  for (size_t idx = 0; idx < fBorn.size(); idx++)
+    input >> fBorn.at(idx) >> fArrived.at(idx) >> fTimeSum.at(idx) >> fTime2Sum.at(idx);
+
+  return static_cast<bool>(input);
+}
+
+bool drc::DRcaloFiberLUT::write(const std::string& filename) const {
+  std::ofstream output(filename);
+
+  if (!output.is_open())
+    return false;
+
+  output.precision(std::numeric_limits<double>::max_digits10);
+  output << "DRcaloFiberLUT " << kVersion << "\n";
+  output << fDistBin << " " << fDistMax << " " << fCosBin << " " << fWavBin << " " << fWavMin << " " << fWavMax << "\n";
+
+  // keep the raw sums rather than the response
+  for (size_t idx = 0; idx < fBorn.size(); idx++)
+    output << fBorn.at(idx) << " " << fArrived.at(idx) << " " << fTimeSum.at(idx) << " " << fTime2Sum.at(idx) << "\n";
+
+  return static_cast<bool>(output);
+}
+
+bool drc::DRcaloFiberLUT::add(const drc::DRcaloFiberLUT& other) {
+  if ( fDistBin!=other.fDistBin || fDistMax!=other.fDistMax || fCosBin!=other.fCosBin ||
+       fWavBin!=other.fWavBin || fWavMin!=other.fWavMin || fWavMax!=other.fWavMax )
+    return false;
+
+  for (size_t idx = 0; idx < fBorn.size(); idx++) {
+    fBorn[idx] += other.fBorn[idx];
+    fArrived[idx] += other.fArrived[idx];
+    fTimeSum[idx] += other.fTimeSum[idx];
+    fTime2Sum[idx] += other.fTime2Sum[idx];
+  }
+
+  return true;
+}
+
+void drc::DRcaloFiberLUT::fill(bool isCerenkov, double dist, double cosTheta, double wavlen, bool arrived, double time, double weight) {
+  int idx = index(isCerenkov,dist,cosTheta,wavlen);
+
+  fBorn.at(idx) += weight;
+
+  if (!arrived)
+    return;
+
+  fArrived.at(idx) += weight;
+  fTimeSum.at(idx) += weight*time;
+  fTime2Sum.at(idx) += weight*time*time;
+}
+
+drc::DRcaloFiberLUT::Response drc::DRcaloFiberLUT::response(bool isCerenkov, double dist, double cosTheta, double wavlen) const {
+  Response resp;
+  int idx = index(isCerenkov,dist,cosTheta,wavlen);
+
+  if ( fBorn.at(idx) <= 0. || fArrived.at(idx) <= 0. )
+    return resp;
+
+  resp.survival = fArrived.at(idx)/fBorn.at(idx);
+  resp.meanTime = fTimeSum.at(idx)/fArrived.at(idx);
+  resp.rmsTime = std::sqrt( std::max( fTime2Sum.at(idx)/fArrived.at(idx) - resp.meanTime*resp.meanTime, 0. ) );
+
+  return resp;
+}
+
+int drc::DRcaloFiberLUT::index(bool isCerenkov, double dist, double cosTheta, double wavlen) const {
+  int distIdx = bin(dist,0.,fDistMax,fDistBin);
+  int cosIdx = bin(cosTheta,-1.,1.,fCosBin);
+  int wavIdx = bin(wavlen,fWavMin,fWavMax,fWavBin);
+
+  return ( ( ( isCerenkov ? 1 : 0 )*fDistBin + distIdx )*fCosBin + cosIdx )*fWavBin + wavIdx;
+}
+
+int drc::DRcaloFiberLUT::bin(double val, double min, double max, int nbin) const {
+  // values outside the range fall into the first or last bin
+  int idx = static_cast<int>( std::floor( (val-min)/(max-min)*static_cast<double>(nbin) ) );
+
+  return std::min( std::max(idx,0), nbin-1 );
+}
@@ -0,0 +1,158 @@
+#include "DRcaloShowerLibrary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
+drc::DRcaloShowerLibrary::DRcaloShowerLibrary(double eMin, double eMax, int eBin, double thetaMax, int thetaBin)
+: fEmin(eMin), fEmax(eMax), fEbin(eBin), fThetaMax(thetaMax), fThetaBin(thetaBin) {}
+
+bool drc::DRcaloShowerLibrary::read(const std::string& filename) {
+  std::ifstream input(filename);
+
+  if (!input.is_open())
+    return false;
+
+  std::string header;
+  int version = 0;
+  input >> header >> version;
+
+  if ( header!="DRcaloShowerLibrary" || version!=kVersion )
+    return false;
+
+  size_t nShower = 0;
+  input >> fEmin >> fEmax >> fEbin >> fThetaMax >> fThetaBin >> nShower;
+
+  if ( !input || fEbin < 1 || fThetaBin < 1 || fEmin <= 0. || fEmax <= fEmin || fThetaMax <= 0. )
+    return false;
+
+  fShowers.clear();
+
+  auto readHist = [&input](Histogram& hist) {
+    size_t nBin = 0;
+    input >> nBin;
+    hist.resize(nBin);
+
+    for (auto& entry : hist)
+      input >> entry.first >> entry.second;
+  };
+
+  for (size_t iShower = 0; iShower < nShower && input; iShower++) {
+    Shower shower;
+    size_t nSiPM = 0;
+    input >> shower.ring >> shower.energy >> shower.theta >> shower.phi >> nSiPM;
+    shower.sipms.resize(nSiPM);
+
+    for (auto& sipm : shower.sipms) {
+      input >> sipm.dx >> sipm.dy;
+      readHist(sipm.time);
+      readHist(sipm.wavlen);
+    }
+
+    add( std::move(shower) );
+  }
+
+  return static_cast<bool>(input);
+}
+
+bool drc::DRcaloShowerLibrary::write(const std::string& filename) const {
+  std::ofstream output(filename);
+
+  if (!output.is_open())
+    return false;
+
+  output.precision(std::numeric_limits<float>::max_digits10);
+  output << "DRcaloShowerLibrary " << kVersion << "\n";
+  output << fEmin << " " << fEmax << " " << fEbin << " " << fThetaMax << " " << fThetaBin << " " << size() << "\n";
+
+  auto writeHist = [&output](const Histogram& hist) {
+    output << " " << hist.size();
+
+    for (const auto& entry : hist)
+      output << " " << entry.first << " " << entry.second;
+  };
+
+  for (const auto& ring : fShowers) {
+    for (const auto& bin : ring.second) {
+      for (const auto& shower : bin.second) {
+        output << shower.ring << " " << shower.energy << " " << shower.theta << " " << shower.phi << " " << shower.sipms.size() << "\n";
+
+        for (const auto& sipm : shower.sipms) {
+          output << sipm.dx << " " << sipm.dy;
+          writeHist(sipm.time);
+          writeHist(sipm.wavlen);
+          output << "\n";
+        }
+      }
+    }
+  }
+
+  return static_cast<bool>(output);
+}
+
+void drc::DRcaloShowerLibrary::add(Shower&& shower) {
+  Key key( energyBin(shower.energy), thetaBin(shower.theta) );
+  fShowers[shower.ring][key].push_back( std::move(shower) );
+}
+
+const drc::DRcaloShowerLibrary::Shower* drc::DRcaloShowerLibrary::find(int ring, double energy, double theta, double rand) const {
+  if ( fShowers.empty() )
+    return nullptr;
+
+  // closest ring with showers (the lower one if tied)
+  auto found = fShowers.lower_bound(ring);
+
+  if ( found==fShowers.end() || ( found->first!=ring && found!=fShowers.begin() && ring - std::prev(found)->first <= found->first - ring ) )
+    found = std::prev( found==fShowers.end() ? fShowers.end() : found );
+
+  const std::vector<Shower>* showers = closestEnergy( found->second, energyBin(energy), thetaBin(theta) );
+
+  if ( !showers || showers->empty() )
+    return nullptr;
+
+  size_t idx = std::min( static_cast<size_t>( rand*static_cast<double>(showers->size()) ), showers->size()-1 );
+
+  return &showers->at(idx);
+}
+
+const std::vector<drc::DRcaloShowerLibrary::Shower>* drc::DRcaloShowerLibrary::closestEnergy(const std::map<Key, std::vector<Shower>>& ring, int eIdx, int thetaIdx) const {
+  const std::vector<Shower>* closest = nullptr;
+  int distance = std::numeric_limits<int>::max();
+
+  // the energy matters more than the angle
+  for (const auto& bin : ring) {
+    int candidate = std::abs( bin.first.first - eIdx )*fThetaBin + std::abs( bin.first.second - thetaIdx );
+
+    if ( candidate < distance ) {
+      distance = candidate;
+      closest = &bin.second;
+    }
+  }
+
+  return closest;
+}
+
+size_t drc::DRcaloShowerLibrary::size() const {
+  size_t num = 0;
+
+  for (const auto& ring : fShowers) {
+    for (const auto& bin : ring.second)
+      num += bin.second.size();
+  }
+
+  return num;
+}
+
+int drc::DRcaloShowerLibrary::energyBin(double energy) const {
+  int idx = static_cast<int>( std::floor( std::log(energy/fEmin)/std::log(fEmax/fEmin)*static_cast<double>(fEbin) ) );
+
+  return std::min( std::max(idx,0), fEbin-1 );
+}
+
+int drc::DRcaloShowerLibrary::thetaBin(double theta) const {
+  int idx = static_cast<int>( std::floor( theta/fThetaMax*static_cast<double>(fThetaBin) ) );
+
+  return std::min( std::max(idx,0), fThetaBin-1 );
+}
@@ -2,10 +2,14 @@
 
 G4ThreadLocal G4Allocator<drc::DRcaloSiPMHit>* drc::DRcaloSiPMHitAllocator = 0;
 
-drc::DRcaloSiPMHit::DRcaloSiPMHit(float wavSampling, float timeSampling)
+drc::DRcaloSiPMHit::DRcaloSiPMHit(float wavSampling, float timeSampling, std::shared_ptr<DRcaloArena> arena)
 : G4VHit(),
+  fArena(arena),
   fSiPMnum(0),
   fPhotons(0),
+  fWavlenSpectrum( arena ? arena.get() : std::pmr::get_default_resource() ),
+  fTimeStruct( arena ? arena.get() : std::pmr::get_default_resource() ),
+  fPhotonRecord( arena ? arena.get() : std::pmr::get_default_resource() ),
   mWavSampling(wavSampling),
   mTimeSampling(timeSampling)
 {}
@@ -13,11 +17,13 @@ drc::DRcaloSiPMHit::DRcaloSiPMHit(float wavSampling, float timeSampling)
 drc::DRcaloSiPMHit::~DRcaloSiPMHit() {}
 
 drc::DRcaloSiPMHit::DRcaloSiPMHit(const drc::DRcaloSiPMHit &right)
-: G4VHit() {
+: G4VHit(),
+  fArena(right.fArena),
+  fWavlenSpectrum( right.fWavlenSpectrum, right.fWavlenSpectrum.get_allocator() ),
+  fTimeStruct( right.fTimeStruct, right.fTimeStruct.get_allocator() ),
+  fPhotonRecord( right.fPhotonRecord, right.fPhotonRecord.get_allocator() ) {
   fSiPMnum = right.fSiPMnum;
   fPhotons = right.fPhotons;
-  fWavlenSpectrum = right.fWavlenSpectrum;
-  fTimeStruct = right.fTimeStruct;
   mWavSampling = right.mWavSampling;
   mTimeSampling = right.mTimeSampling;
 }
@@ -27,6 +33,7 @@ const drc::DRcaloSiPMHit& drc::DRcaloSiPMHit::operator=(const drc::DRcaloSiPMHit
   fPhotons = right.fPhotons;
   fWavlenSpectrum = right.fWavlenSpectrum;
   fTimeStruct = right.fTimeStruct;
+  fPhotonRecord = right.fPhotonRecord;
   mWavSampling = right.mWavSampling;
   mTimeSampling = right.mTimeSampling;
   return *this;
@@ -36,14 +43,14 @@ G4bool drc::DRcaloSiPMHit::operator==(const drc::DRcaloSiPMHit &right) const {
   return (fSiPMnum==right.fSiPMnum);
 }
 
-void drc::DRcaloSiPMHit::CountWavlenSpectrum(float center) {
+void drc::DRcaloSiPMHit::CountWavlenSpectrum(float center, int weight) {
   auto it = fWavlenSpectrum.find(center);
-  if (it==fWavlenSpectrum.end()) fWavlenSpectrum.insert(std::make_pair(center,1));
-  else it->second++;
+  if (it==fWavlenSpectrum.end()) fWavlenSpectrum.insert(std::make_pair(center,weight));
+  else it->second += weight;
 }
 
-void drc::DRcaloSiPMHit::CountTimeStruct(float center) {
+void drc::DRcaloSiPMHit::CountTimeStruct(float center, int weight) {
   auto it = fTimeStruct.find(center);
-  if (it==fTimeStruct.end()) fTimeStruct.insert(std::make_pair(center,1));
-  else it->second++;
+  if (it==fTimeStruct.end()) fTimeStruct.insert(std::make_pair(center,weight));
+  else it->second += weight;
 }
@@ -8,13 +8,45 @@
 #include "G4SDManager.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4ParticleTypes.hh"
+#include "G4NavigationHistory.hh"
+#include "G4AutoLock.hh"
 
 #include "G4SystemOfUnits.hh"
 #include "DD4hep/DD4hepUnits.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <set>
+
+namespace {
+  G4Mutex recordMutex = G4MUTEX_INITIALIZER;
+  std::set<std::string> recordedSDs;
+  std::set<std::string> heapSDs;
+  std::atomic<bool> filteredPhotons(false);
+}
+
+void drc::DRcaloSiPMSD::recordPhotonsOf(const std::string& sdName) {
+  G4AutoLock lock(&recordMutex);
+  recordedSDs.insert(sdName);
+}
+
+void drc::DRcaloSiPMSD::heapPayloadsOf(const std::string& sdName) {
+  G4AutoLock lock(&recordMutex);
+  heapSDs.insert(sdName);
+}
+
+void drc::DRcaloSiPMSD::setFilteredAtBirth(bool filtered) {
+  filteredPhotons = filtered;
+}
+
+bool drc::DRcaloSiPMSD::filteredAtBirth() {
+  return filteredPhotons;
+}
+
 drc::DRcaloSiPMSD::DRcaloSiPMSD(const std::string aName, const std::string aReadoutName, const dd4hep::Segmentation& aSeg)
 : G4VSensitiveDetector(aName), fHitCollection(0), fHCID(-1),
-fWavBin(120), fTimeBin(600), fWavlenStart(900.), fWavlenEnd(300.), fTimeStart(10.), fTimeEnd(70.)
+fWavBin(120), fTimeBin(600), fWavlenStart(900.), fWavlenEnd(300.), fTimeStart(10.), fTimeEnd(70.), fRecordPhotons(false), fBulkPayloads(true)
 {
   collectionName.insert(aReadoutName);
   fSeg = dynamic_cast<dd4hep::DDSegmentation::GridDRcalo*>( aSeg.segmentation() );
@@ -28,6 +60,23 @@ void drc::DRcaloSiPMSD::Initialize(G4HCofThisEvent* hce) {
   fHitCollection = new drc::DRcaloSiPMHitsCollection(SensitiveDetectorName,collectionName[0]);
   if (fHCID<0) { fHCID = GetCollectionID(0); }
   hce->AddHitsCollection(fHCID,fHitCollection);
+  fHitIndex.clear();
+
+  if (!fRecordPhotons) {
+    G4AutoLock lock(&recordMutex);
+    fRecordPhotons = ( recordedSDs.find(SensitiveDetectorName)!=recordedSDs.end() );
+  }
+
+  if (fBulkPayloads) {
+    G4AutoLock lock(&recordMutex);
+    fBulkPayloads = ( heapSDs.find(SensitiveDetectorName)==heapSDs.end() );
+  }
+
+  // the arena is reused once the hits of the previous event are gone, a kept event holds on to its own
+  if ( fArena && fArena.use_count()==1 && fArena->isBulk()==fBulkPayloads )
+    fArena->release();
+  else
+    fArena = std::make_shared<DRcaloArena>(fBulkPayloads);
 }
 
 G4bool drc::DRcaloSiPMSD::ProcessHits(G4Step* step, G4TouchableHistory*) {
@@ -45,42 +94,86 @@ G4bool drc::DRcaloSiPMSD::ProcessHits(G4Step* step, G4TouchableHistory*) {
 
   auto cID = fSeg->cellID(loc, glob, volID);
 
-  G4int nofHits = fHitCollection->entries();
   G4double hitTime = step->GetPostStepPoint()->GetGlobalTime();
   G4double energy = step->GetTrack()->GetTotalEnergy();
+  G4int weight = static_cast<G4int>( std::lround( step->GetTrack()->GetWeight() ) ); // weighted optical photons
 
-  drc::DRcaloSiPMHit* hit = NULL;
+  addPhoton(cID, hitTime, energy, weight);
 
-  for (G4int i = 0; i < nofHits; i++) {
-    if ( (*fHitCollection)[i]->GetSiPMnum()==cID ) {
-      hit = (*fHitCollection)[i];
-      break;
-    }
-  }
+  return true;
+}
 
-  if (hit==NULL) {
-    hit = new DRcaloSiPMHit(fWavlenStep,fTimeStep);
-    hit->SetSiPMnum(cID);
+void drc::DRcaloSiPMSD::EndOfEvent(G4HCofThisEvent*) {
+  for (auto& hook : fEndOfEventHooks)
+    hook();
+}
 
-    fHitCollection->insert(hit);
-  }
+void drc::DRcaloSiPMSD::addPhoton(dd4hep::DDSegmentation::CellID cID, G4double hitTime, G4double energy, G4int weight) {
+  countPhoton(findHit(cID), hitTime, energy, weight);
+}
 
-  hit->photonCount();
+void drc::DRcaloSiPMSD::addPhotons(dd4hep::DDSegmentation::CellID cID, size_t n, const G4double* times, const G4double* energies, const G4int* weights) {
+  drc::DRcaloSiPMHit* hit = findHit(cID);
+
+  for (size_t idx = 0; idx < n; idx++)
+    countPhoton(hit, times[idx], energies[idx], weights[idx]);
+}
+
+drc::DRcaloSiPMHit* drc::DRcaloSiPMSD::findHit(dd4hep::DDSegmentation::CellID cID) {
+  auto found = fHitIndex.find(cID);
+
+  if ( found!=fHitIndex.end() )
+    return found->second;
+
+  drc::DRcaloSiPMHit* hit = new DRcaloSiPMHit(fWavlenStep,fTimeStep,fArena);
+  hit->SetSiPMnum(cID);
+
+  fHitCollection->insert(hit);
+  fHitIndex.emplace(cID,hit);
+
+  return hit;
+}
+
+void drc::DRcaloSiPMSD::countPhoton(drc::DRcaloSiPMHit* hit, G4double hitTime, G4double energy, G4int weight) {
+  hit->photonCount(weight);
 
   float wavCenter = findWavCenter(energy);
-  hit->CountWavlenSpectrum(wavCenter);
+  hit->CountWavlenSpectrum(wavCenter,weight);
 
   float timeCenter = findTimeCenter(hitTime);
-  hit->CountTimeStruct(timeCenter);
+  hit->CountTimeStruct(timeCenter,weight);
 
-  return true;
+  if (fRecordPhotons)
+    hit->RecordPhoton(hitTime/CLHEP::ns, eToWav(energy)/nm, weight);
+}
+
+dd4hep::DDSegmentation::CellID drc::DRcaloSiPMSD::fiberCellID(const G4VTouchable* touchable) const {
+  const G4NavigationHistory* history = touchable->GetHistory();
+
+  return sipmCellID( history, history->GetTopTransform().InverseTransformPoint( G4ThreeVector(0.,0.,0.) ) );
+}
+
+dd4hep::DDSegmentation::CellID drc::DRcaloSiPMSD::sipmCellID(const G4NavigationHistory* history, const G4ThreeVector& global) const {
+  const G4int towerLevel = 2;
+
+  // the SiPM layer shares the x & y of the tower frame
+  G4ThreeVector local = history->GetTransform(towerLevel).TransformPoint( global );
+  dd4hep::Position loc(local.x() * dd4hep::millimeter/CLHEP::millimeter, local.y() * dd4hep::millimeter/CLHEP::millimeter, 0.);
+  dd4hep::Position glob(global.x() * dd4hep::millimeter/CLHEP::millimeter, global.y() * dd4hep::millimeter/CLHEP::millimeter, global.z() * dd4hep::millimeter/CLHEP::millimeter);
+
+  auto towerId64 = fSeg->convertFirst32to64( history->GetReplicaNo(towerLevel) );
+
+  return fSeg->cellID(loc, glob, towerId64);
 }
 
 float drc::DRcaloSiPMSD::findWavCenter(G4double en) {
-  int i = 0;
-  for ( ; i < fWavBin+1; i++) {
-    if ( en < wavToE( (fWavlenStart - static_cast<float>(i)*fWavlenStep)*nm ) ) break;
-  }
+  // i is the first edge above en (the edges are in decreasing wavelength), 0 or fWavBin+1 for the under/overflow
+  auto below = [this,en](int idx) { return en < wavToE( (fWavlenStart - static_cast<float>(idx)*fWavlenStep)*nm ); };
+  const double guess = std::floor( ( fWavlenStart - eToWav(en)/nm )/fWavlenStep ) + 1.;
+  int i = guess > 0. ? static_cast<int>( std::min( guess, static_cast<double>(fWavBin+1) ) ) : 0;
+
+  while ( i > 0 && below(i-1) ) i--;
+  while ( i < fWavBin+1 && !below(i) ) i++;
 
   if (i==0) return (fWavlenStart + 0.5*fWavlenStep);
   else if (i==fWavBin+1) return (fWavlenEnd - 0.5*fWavlenStep);
@@ -89,10 +182,13 @@ float drc::DRcaloSiPMSD::findWavCenter(G4double en) {
 }
 
 float drc::DRcaloSiPMSD::findTimeCenter(G4double stepTime) {
-  int i = 0;
-  for ( ; i < fTimeBin+1; i++) {
-    if ( stepTime < ( (fTimeStart + static_cast<float>(i)*fTimeStep)*CLHEP::ns ) ) break;
-  }
+  // i is the first edge above stepTime, 0 or fTimeBin+1 for the under/overflow
+  auto below = [this,stepTime](int idx) { return stepTime < ( (fTimeStart + static_cast<float>(idx)*fTimeStep)*CLHEP::ns ); };
+  const double guess = std::floor( ( stepTime/CLHEP::ns - fTimeStart )/fTimeStep ) + 1.;
+  int i = guess > 0. ? static_cast<int>( std::min( guess, static_cast<double>(fTimeBin+1) ) ) : 0;
+
+  while ( i > 0 && below(i-1) ) i--;
+  while ( i < fTimeBin+1 && !below(i) ) i++;
 
   if (i==0) return (fTimeStart - 0.5*fTimeStep);
   else if (i==fTimeBin+1) return (fTimeEnd + 0.5*fTimeStep);
@@ -4,7 +4,9 @@
 #include "edm4hep/SimCalorimeterHitCollection.h"
 #include "edm4hep/RawCalorimeterHitCollection.h"
 #include "edm4hep/CalorimeterHitCollection.h"
-#include "edm4hep/SparseVectorCollection.h"
+#include "edm4hep/SparseWaveformCollection.h"
+
+#include "DRcaloWaveform.h"
 
 #include "podio/ROOTReader.h"
 #include "podio/EventStore.h"
@@ -62,13 +64,13 @@ int main(int , char* argv[]) {
     if (iEvt % 100 == 0) printf("Analyzing %dth event ...\n", iEvt);
 
     auto& edepHits = pStore->get<edm4hep::SimCalorimeterHitCollection>("SimCalorimeterHits");
-    auto& rawTimeStructs = pStore->get<edm4hep::SparseVectorCollection>("RawTimeStructs");
-    auto& rawWavlenStructs = pStore->get<edm4hep::SparseVectorCollection>("RawWavlenStructs");
-    auto& digiWaveforms = pStore->get<edm4hep::SparseVectorCollection>("DigiWaveforms");
+    auto& rawTimeStructs = pStore->get<edm4hep::SparseWaveformCollection>("RawTimeStructs");
+    auto& rawWavlenStructs = pStore->get<edm4hep::SparseWaveformCollection>("RawWavlenStructs");
+    auto& digiWaveforms = pStore->get<edm4hep::SparseWaveformCollection>("DigiWaveforms");
     auto& caloHits = pStore->get<edm4hep::CalorimeterHitCollection>("DRcalo2dHits");
     auto& rawHits = pStore->get<edm4hep::RawCalorimeterHitCollection>("RawCalorimeterHits");
     auto& digiHits = pStore->get<edm4hep::RawCalorimeterHitCollection>("DigiCalorimeterHits");
-    auto& procTimes = pStore->get<edm4hep::SparseVectorCollection>("DRpostprocTime");
+    auto& procTimes = pStore->get<edm4hep::SparseWaveformCollection>("DRpostprocTime");
 
     float Edep = 0.;
     for (unsigned int iEdep = 0; iEdep < edepHits.size(); iEdep++)
@@ -105,25 +107,10 @@ int main(int , char* argv[]) {
       if ( digiHit.getAmplitude() > 0 )
         tInt->Fill(static_cast<double>(digiHit.getAmplitude()));
 
-      for (unsigned int bin = 0; bin < timeStruct.centers_size(); bin++) {
-        float timeBin = timeStruct.getCenters(bin);
-        tT->Fill(timeBin,timeStruct.getContents(bin));
-      }
-
-      for (unsigned int bin = 0; bin < wavlenStruct.centers_size(); bin++) {
-        float wavlenBin = wavlenStruct.getCenters(bin);
-        tWav->Fill(wavlenBin,wavlenStruct.getContents(bin));
-      }
-
-      for (unsigned int bin = 0; bin < waveform.centers_size(); bin++) {
-        float timeBin = waveform.getCenters(bin);
-        tD->Fill(timeBin,waveform.getContents(bin));
-      }
-
-      for (unsigned int bin = 0; bin < procTime.centers_size(); bin++) {
-        float timeBin = procTime.getCenters(bin);
-        tProc->Fill(timeBin,procTime.getContents(bin));
-      }
+      drc::waveform::forEachBin( timeStruct, [tT](double timeBin, double content) { tT->Fill(timeBin,content); } );
+      drc::waveform::forEachBin( wavlenStruct, [tWav](double wavlenBin, double content) { tWav->Fill(wavlenBin,content); } );
+      drc::waveform::forEachBin( waveform, [tD](double timeBin, double content) { tD->Fill(timeBin,content); } );
+      drc::waveform::forEachBin( procTime, [tProc](double timeBin, double content) { tProc->Fill(timeBin,content); } );
     }
 
     E_Ss.push_back(en_S);
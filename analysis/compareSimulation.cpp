@@ -0,0 +1,107 @@
+#include "edm4hep/RawCalorimeterHitCollection.h"
+#include "edm4hep/SimCalorimeterHitCollection.h"
+
+#include "podio/ROOTReader.h"
+#include "podio/EventStore.h"
+
+#include "TFile.h"
+#include "TH1.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// compares a simulation with a speed-up setting, e.g. the kill policy of SimG4DRcaloActions or the production cuts
+// of the DRcalo regions, against a reference without it for the same primaries: the shift & resolution
+// of the number of p.e. and of the MC truth energy deposit per event, and the CPU time saved
+// if the times per event are given (printed by SimG4DRcaloRunAction at the end of the run)
+
+namespace {
+  struct moments {
+    double sum = 0.;
+    double sum2 = 0.;
+    unsigned int n = 0;
+
+    void fill(double val) { sum += val; sum2 += val*val; n++; }
+    double mean() const { return n > 0 ? sum/static_cast<double>(n) : 0.; }
+    double var() const { return n > 1 ? ( sum2 - sum*sum/static_cast<double>(n) )/static_cast<double>(n-1) : 0.; }
+    double resolution() const { return mean() > 0. ? std::sqrt(var())/mean() : 0.; }
+  };
+
+  void readFile(const std::string& filename, moments& nPE, moments& edep, TH1F* histPE, TH1F* histEdep) {
+    auto pReader = std::make_unique<podio::ROOTReader>();
+    pReader->openFile(filename);
+
+    auto pStore = std::make_unique<podio::EventStore>();
+    pStore->setReader(pReader.get());
+
+    unsigned int entries = pReader->getEntries();
+    for (unsigned int iEvt = 0; iEvt < entries; iEvt++) {
+      auto& rawHits = pStore->get<edm4hep::RawCalorimeterHitCollection>("RawCalorimeterHits");
+      auto& simHits = pStore->get<edm4hep::SimCalorimeterHitCollection>("SimCalorimeterHits");
+
+      double nPhotons = 0.;
+      for (unsigned int idx = 0; idx < rawHits.size(); idx++)
+        nPhotons += static_cast<double>( rawHits.at(idx).getAmplitude() );
+
+      double energy = 0.;
+      for (unsigned int idx = 0; idx < simHits.size(); idx++)
+        energy += static_cast<double>( simHits.at(idx).getEnergy() );
+
+      nPE.fill(nPhotons);
+      edep.fill(energy);
+      histPE->Fill(nPhotons);
+      histEdep->Fill(energy);
+
+      pStore->clear();
+      pReader->endOfEvent();
+    }
+  }
+
+  void print(const std::string& name, const moments& reference, const moments& test) {
+    std::cout << name << std::endl;
+    std::cout << "  reference : mean " << reference.mean() << " sigma/mean " << reference.resolution() << std::endl;
+    std::cout << "  test      : mean " << test.mean() << " sigma/mean " << test.resolution() << std::endl;
+    std::cout << "  mean shift " << ( reference.mean() > 0. ? test.mean()/reference.mean() - 1. : 0. )
+              << ", resolution ratio " << ( reference.resolution() > 0. ? test.resolution()/reference.resolution() : 0. ) << std::endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cout << "usage: compareSimulation <reference.root> <test.root> [<reference s/evt> <test s/evt>]" << std::endl;
+    return 1;
+  }
+
+  std::string referenceFile = argv[1];
+  std::string testFile = argv[2];
+
+  TH1F* tN_reference = new TH1F("nPhoton_reference","Number of p.e. per event;p.e.;Evt",200,0.,0.);
+  TH1F* tN_test = new TH1F("nPhoton_test","Number of p.e. per event;p.e.;Evt",200,0.,0.);
+  TH1F* tE_reference = new TH1F("edep_reference","MC truth energy deposit per event;GeV;Evt",200,0.,0.);
+  TH1F* tE_test = new TH1F("edep_test","MC truth energy deposit per event;GeV;Evt",200,0.,0.);
+
+  moments nPE_reference, nPE_test, edep_reference, edep_test;
+  readFile(referenceFile, nPE_reference, edep_reference, tN_reference, tE_reference);
+  readFile(testFile, nPE_test, edep_test, tN_test, tE_test);
+
+  print("p.e. per event", nPE_reference, nPE_test);
+  print("MC truth energy deposit per event", edep_reference, edep_test);
+
+  if (argc > 4) {
+    double timeReference = std::stod(argv[3]);
+    double timeTest = std::stod(argv[4]);
+
+    std::cout << "CPU time per event " << timeReference << " s vs " << timeTest << " s, saved "
+              << 100.*( 1. - timeTest/timeReference ) << "%" << std::endl;
+  }
+
+  TFile* validFile = new TFile("comparison.root","RECREATE");
+  validFile->WriteTObject(tN_reference);
+  validFile->WriteTObject(tN_test);
+  validFile->WriteTObject(tE_reference);
+  validFile->WriteTObject(tE_test);
+  validFile->Close();
+
+  return 0;
+}
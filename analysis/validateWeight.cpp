@@ -0,0 +1,93 @@
+#include "edm4hep/RawCalorimeterHitCollection.h"
+
+#include "podio/ROOTReader.h"
+#include "podio/EventStore.h"
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TString.h"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// compares the photon counting statistics of a weighted simulation (photonWeight = w)
+// against an unweighted one with the same primaries
+// a weighted photon is counted in lumps of w, so the variance is expected to grow by (w-1)*mean
+
+namespace {
+  struct moments {
+    double sum = 0.;
+    double sum2 = 0.;
+    unsigned int n = 0;
+
+    void fill(double val) { sum += val; sum2 += val*val; n++; }
+    double mean() const { return n > 0 ? sum/static_cast<double>(n) : 0.; }
+    double var() const { return n > 1 ? ( sum2 - sum*sum/static_cast<double>(n) )/static_cast<double>(n-1) : 0.; }
+  };
+
+  void readFile(const std::string& filename, moments& perEvent, TH1F* hist) {
+    auto pReader = std::make_unique<podio::ROOTReader>();
+    pReader->openFile(filename);
+
+    auto pStore = std::make_unique<podio::EventStore>();
+    pStore->setReader(pReader.get());
+
+    unsigned int entries = pReader->getEntries();
+    for (unsigned int iEvt = 0; iEvt < entries; iEvt++) {
+      auto& rawHits = pStore->get<edm4hep::RawCalorimeterHitCollection>("RawCalorimeterHits");
+
+      double nPhotons = 0.;
+      for (unsigned int idx = 0; idx < rawHits.size(); idx++)
+        nPhotons += static_cast<double>( rawHits.at(idx).getAmplitude() );
+
+      perEvent.fill(nPhotons);
+      hist->Fill(nPhotons);
+
+      pStore->clear();
+      pReader->endOfEvent();
+    }
+  }
+
+  void print(const std::string& name, const moments& unweighted, const moments& weighted, int weight) {
+    double predicted = unweighted.var() + static_cast<double>(weight-1)*unweighted.mean();
+
+    std::cout << name << std::endl;
+    std::cout << "  unweighted : mean " << unweighted.mean() << " variance " << unweighted.var()
+              << " Fano " << unweighted.var()/unweighted.mean()
+              << " sigma/mean " << std::sqrt(unweighted.var())/unweighted.mean() << std::endl;
+    std::cout << "  weighted   : mean " << weighted.mean() << " variance " << weighted.var()
+              << " Fano " << weighted.var()/weighted.mean()
+              << " sigma/mean " << std::sqrt(weighted.var())/weighted.mean() << std::endl;
+    std::cout << "  expected variance of the weighted run " << predicted
+              << " (ratio " << weighted.var()/predicted << ")" << std::endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 4) {
+    std::cout << "usage: validateWeight <unweighted.root> <weighted.root> <weight>" << std::endl;
+    return 1;
+  }
+
+  std::string unweightedFile = argv[1];
+  std::string weightedFile = argv[2];
+  int weight = std::stoi(argv[3]);
+
+  TH1F* tN_unweighted = new TH1F("nPhoton_unweighted","Number of p.e. per event;p.e.;Evt",200,0.,0.);
+  TH1F* tN_weighted = new TH1F("nPhoton_weighted","Number of p.e. per event;p.e.;Evt",200,0.,0.);
+
+  moments unweighted, weighted;
+  readFile(unweightedFile, unweighted, tN_unweighted);
+  readFile(weightedFile, weighted, tN_weighted);
+
+  print("p.e. per event", unweighted, weighted, weight);
+
+  TFile* validFile = new TFile("weight_validation.root","RECREATE");
+  validFile->WriteTObject(tN_unweighted);
+  validFile->WriteTObject(tN_weighted);
+  validFile->Close();
+
+  return 0;
+}